@@ -0,0 +1,385 @@
+#pragma once
+
+#include "compressed_bitmap.hpp"
+#include "framebuffer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Animation container, all multi-byte fields are little endian
+//   header: width u8, height u8, frame_count u16, frame_period_ms u16
+//   frame:  type u8, payload_size u16, payload
+//     KEYFRAME payload: the whole page-major frame, RLE encoded
+//     DELTA payload:    span_count u16, then per span page u8, column u8, length u8 and
+//                       the RLE encoded XOR of the span against the previous frame
+// the first frame is always a keyframe so playback can loop
+
+namespace ssd1306_pico
+{
+    enum class AnimationFrameType : uint8_t
+    {
+        KEYFRAME = 0,
+        DELTA    = 1
+    };
+
+    class Animation
+    {
+    public:
+        static constexpr size_t HEADER_SIZE       = 6;
+        static constexpr size_t FRAME_HEADER_SIZE = 3;
+        static constexpr size_t SPAN_HEADER_SIZE  = 3;
+
+        constexpr Animation(const uint8_t* data) : _data(data)
+        {
+        }
+
+        [[nodiscard]] constexpr uint8_t get_width() const
+        {
+            return _data[0];
+        }
+
+        [[nodiscard]] constexpr uint8_t get_height() const
+        {
+            return _data[1];
+        }
+
+        [[nodiscard]] constexpr uint16_t get_frame_count() const
+        {
+            return _data[2] | (_data[3] << 8);
+        }
+
+        [[nodiscard]] constexpr uint16_t get_frame_period_ms() const
+        {
+            return _data[4] | (_data[5] << 8);
+        }
+
+        [[nodiscard]] constexpr const uint8_t* get_first_frame() const
+        {
+            return _data + HEADER_SIZE;
+        }
+
+    private:
+        const uint8_t* _data;
+    };
+
+    [[nodiscard]] constexpr size_t encode_animation_header(uint8_t width, uint8_t height, uint16_t frame_count, uint16_t frame_period_ms, uint8_t* output, size_t output_capacity)
+    {
+        if (output_capacity < Animation::HEADER_SIZE)
+            return 0;
+
+        output[0] = width;
+        output[1] = height;
+        output[2] = frame_count & 0xFF;
+        output[3] = frame_count >> 8;
+        output[4] = frame_period_ms & 0xFF;
+        output[5] = frame_period_ms >> 8;
+
+        return Animation::HEADER_SIZE;
+    }
+
+    // the rows of a page that belong to the animation, the last page of one whose height isn't a multiple of 8
+    // has padding rows below it that deltas must leave alone
+    [[nodiscard]] constexpr uint8_t get_animation_page_mask(uint8_t page, uint8_t height)
+    {
+        if (page != (height + 7) / 8 - 1 || height % 8 == 0)
+            return 0xFF;
+
+        return 0xFF >> (8 - height % 8);
+    }
+
+    // encodes current as a delta against previous, or as a keyframe when previous is null or the delta isn't smaller
+    // returns the frame size including its header, or 0 if it doesn't fit in output_capacity
+    [[nodiscard]] constexpr size_t encode_animation_frame(const uint8_t* previous, const uint8_t* current, uint8_t width, uint8_t height, uint8_t* output, size_t output_capacity)
+    {
+        // equal bytes shorter than this are folded into a span, a new span costs its header plus an RLE control byte
+        constexpr uint8_t MIN_GAP = Animation::SPAN_HEADER_SIZE + 1;
+
+        const size_t frame_size = static_cast<size_t>(width) * ((height + 7) / 8);
+        const uint8_t pages     = (height + 7) / 8;
+
+        if (output_capacity < Animation::FRAME_HEADER_SIZE)
+            return 0;
+
+        size_t keyframe_size = rle_encode(current, frame_size, output + Animation::FRAME_HEADER_SIZE, output_capacity - Animation::FRAME_HEADER_SIZE);
+        if (keyframe_size == 0)
+            return 0;
+
+        output[0] = static_cast<uint8_t>(AnimationFrameType::KEYFRAME);
+        output[1] = keyframe_size & 0xFF;
+        output[2] = keyframe_size >> 8;
+
+        if (previous == nullptr)
+            return keyframe_size + Animation::FRAME_HEADER_SIZE;
+
+        // the delta is built right after the keyframe and moved over it if it turns out smaller
+        uint8_t* delta        = output + Animation::FRAME_HEADER_SIZE + keyframe_size;
+        size_t delta_capacity = output_capacity - Animation::FRAME_HEADER_SIZE - keyframe_size;
+        size_t delta_size     = 2;
+        uint16_t span_count   = 0;
+        uint8_t xors[255]     = {};
+
+        if (delta_capacity < Animation::FRAME_HEADER_SIZE + 2)
+            return keyframe_size + Animation::FRAME_HEADER_SIZE;
+
+        for (uint8_t page = 0; page < pages; page++)
+        {
+            const uint8_t* prev_page = previous + page * width;
+            const uint8_t* cur_page  = current + page * width;
+            const uint8_t mask       = get_animation_page_mask(page, height);
+
+            uint8_t column = 0;
+            while (column < width)
+            {
+                if (((prev_page[column] ^ cur_page[column]) & mask) == 0)
+                {
+                    column++;
+                    continue;
+                }
+
+                uint8_t start = column;
+                uint8_t end   = column + 1;
+
+                for (uint8_t next = end; next < width && next - end < MIN_GAP; next++)
+                {
+                    if (((prev_page[next] ^ cur_page[next]) & mask) != 0)
+                        end = next + 1;
+                }
+
+                uint8_t length = end - start;
+                for (uint8_t i = 0; i < length; i++)
+                    xors[i] = (prev_page[start + i] ^ cur_page[start + i]) & mask;
+
+                size_t span_pos = Animation::FRAME_HEADER_SIZE + delta_size;
+                if (span_pos + Animation::SPAN_HEADER_SIZE >= delta_capacity)
+                    return keyframe_size + Animation::FRAME_HEADER_SIZE;
+
+                size_t encoded = rle_encode(xors, length, delta + span_pos + Animation::SPAN_HEADER_SIZE, delta_capacity - span_pos - Animation::SPAN_HEADER_SIZE);
+                if (encoded == 0)
+                    return keyframe_size + Animation::FRAME_HEADER_SIZE;
+
+                delta[span_pos]     = page;
+                delta[span_pos + 1] = start;
+                delta[span_pos + 2] = length;
+
+                delta_size += Animation::SPAN_HEADER_SIZE + encoded;
+                span_count++;
+                column = end;
+            }
+        }
+
+        if (delta_size >= keyframe_size)
+            return keyframe_size + Animation::FRAME_HEADER_SIZE;
+
+        delta[0] = static_cast<uint8_t>(AnimationFrameType::DELTA);
+        delta[1] = delta_size & 0xFF;
+        delta[2] = delta_size >> 8;
+        delta[3] = span_count & 0xFF;
+        delta[4] = span_count >> 8;
+
+        for (size_t i = 0; i < delta_size + Animation::FRAME_HEADER_SIZE; i++)
+            output[i] = delta[i];
+
+        return delta_size + Animation::FRAME_HEADER_SIZE;
+    }
+
+    // Plays an animation in place on a framebuffer, keyframes are decoded straight into it and deltas are XORed
+    // over the previous frame, so only the changed spans end up dirty and get sent on the next render.
+    // both go through the framebuffer's current translation and clip, which have to stay the same from frame to
+    // frame, and nothing else should draw over the animation area between frames
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    class AnimationPlayer
+    {
+    public:
+        AnimationPlayer(const Animation& animation, uint8_t x = 0, uint8_t page = 0);
+        AnimationPlayer(const AnimationPlayer& player)            = delete;
+        AnimationPlayer(AnimationPlayer&& player)                 = delete;
+        AnimationPlayer& operator=(const AnimationPlayer& player) = delete;
+        AnimationPlayer& operator=(AnimationPlayer&& player)      = delete;
+        ~AnimationPlayer()                                        = default;
+
+        void restart();
+        void next_frame(FrameBuffer<WIDTH, HEIGHT>& framebuffer);
+
+        // frames one update plays at most after a stall, the rest follow on later updates
+        static constexpr uint8_t MAX_CATCH_UP_FRAMES = 8;
+
+        // applies the frames that are due at now_us, returns whether the framebuffer changed. missed frames are
+        // skipped up to the latest keyframe among them, past that at most MAX_CATCH_UP_FRAMES are played and
+        // the animation runs late
+        bool update(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint64_t now_us);
+
+        [[nodiscard]] uint16_t get_frame_index() const;
+
+    private:
+        void _apply_delta(FrameBuffer<WIDTH, HEIGHT>& framebuffer, const uint8_t* payload);
+
+        // moves to the latest keyframe within the next frame_count frames without drawing, returns the frames
+        // skipped
+        uint64_t _skip_to_keyframe(uint64_t frame_count);
+
+    private:
+        Animation _animation;
+        uint8_t _x;
+        uint8_t _page;
+
+        const uint8_t* _next_frame;
+        uint16_t _frame_index = 0;
+
+        uint64_t _next_frame_us = 0;
+        bool _is_started        = false;
+    };
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    AnimationPlayer<WIDTH, HEIGHT>::AnimationPlayer(const Animation& animation, uint8_t x, uint8_t page) : _animation(animation), _x(x), _page(page), _next_frame(animation.get_first_frame())
+    {
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void AnimationPlayer<WIDTH, HEIGHT>::restart()
+    {
+        _next_frame  = _animation.get_first_frame();
+        _frame_index = 0;
+        _is_started  = false;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void AnimationPlayer<WIDTH, HEIGHT>::next_frame(FrameBuffer<WIDTH, HEIGHT>& framebuffer)
+    {
+        if (_frame_index >= _animation.get_frame_count())
+        {
+            _next_frame  = _animation.get_first_frame();
+            _frame_index = 0;
+        }
+
+        AnimationFrameType type = static_cast<AnimationFrameType>(_next_frame[0]);
+        uint16_t payload_size   = _next_frame[1] | (_next_frame[2] << 8);
+        const uint8_t* payload  = _next_frame + Animation::FRAME_HEADER_SIZE;
+
+        if (type == AnimationFrameType::KEYFRAME)
+        {
+            CompressedBitmap frame(_animation.get_width(), _animation.get_height(), payload);
+            framebuffer.draw_compressed_bitmap(_x, _page * 8, 0, 0, frame.get_width(), frame.get_height(), frame);
+        }
+        else
+        {
+            _apply_delta(framebuffer, payload);
+        }
+
+        _next_frame = payload + payload_size;
+        _frame_index++;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool AnimationPlayer<WIDTH, HEIGHT>::update(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint64_t now_us)
+    {
+        uint64_t period_us = _animation.get_frame_period_ms() * 1000ull;
+
+        if (!_is_started)
+        {
+            _is_started    = true;
+            _next_frame_us = now_us;
+        }
+
+        if (now_us < _next_frame_us)
+            return false;
+
+        if (period_us == 0)
+        {
+            next_frame(framebuffer);
+            return true;
+        }
+
+        uint64_t due_count = (now_us - _next_frame_us) / period_us + 1;
+        _next_frame_us += due_count * period_us;
+
+        // deltas build on each other, so missed frames can only be dropped up to a keyframe
+        due_count -= _skip_to_keyframe(due_count);
+
+        if (due_count > MAX_CATCH_UP_FRAMES)
+        {
+            _next_frame_us = now_us + period_us;
+            due_count      = MAX_CATCH_UP_FRAMES;
+        }
+
+        for (uint64_t i = 0; i < due_count; i++)
+            next_frame(framebuffer);
+
+        return true;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    uint16_t AnimationPlayer<WIDTH, HEIGHT>::get_frame_index() const
+    {
+        return _frame_index;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    uint64_t AnimationPlayer<WIDTH, HEIGHT>::_skip_to_keyframe(uint64_t frame_count)
+    {
+        const uint16_t animation_frames = _animation.get_frame_count();
+        if (animation_frames == 0)
+            return 0;
+
+        // the first frame is a keyframe, so whole loops past the first can be skipped without looking at them
+        uint64_t looped = 0;
+        if (frame_count > 2 * animation_frames)
+        {
+            looped = (frame_count - animation_frames) / animation_frames * animation_frames;
+            frame_count -= looped;
+        }
+
+        const uint8_t* frame = _next_frame;
+        uint16_t index       = _frame_index;
+        uint64_t skipped     = 0;
+
+        for (uint64_t ahead = 0; ahead < frame_count; ahead++)
+        {
+            if (index >= animation_frames)
+            {
+                frame = _animation.get_first_frame();
+                index = 0;
+            }
+
+            if (ahead > 0 && static_cast<AnimationFrameType>(frame[0]) == AnimationFrameType::KEYFRAME)
+            {
+                _next_frame  = frame;
+                _frame_index = index;
+                skipped      = ahead;
+            }
+
+            frame += Animation::FRAME_HEADER_SIZE + (frame[1] | (frame[2] << 8));
+            index++;
+        }
+
+        return skipped + looped;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void AnimationPlayer<WIDTH, HEIGHT>::_apply_delta(FrameBuffer<WIDTH, HEIGHT>& framebuffer, const uint8_t* payload)
+    {
+        uint16_t span_count = payload[0] | (payload[1] << 8);
+        const uint8_t* span = payload + 2;
+
+        // a span is decoded whole so it's clipped once, like the keyframes it builds on
+        uint8_t xors[255];
+
+        for (uint16_t i = 0; i < span_count; i++)
+        {
+            uint8_t page   = span[0];
+            uint8_t column = span[1];
+            uint8_t length = span[2];
+
+            RleReader reader(span + Animation::SPAN_HEADER_SIZE);
+            for (uint8_t offset = 0; offset < length; offset++)
+                xors[offset] = reader.next();
+
+            // the padding rows below the last page are masked off by the strip's height
+            uint8_t rows = std::min(_animation.get_height() - page * 8, 8);
+            framebuffer.xor_strip(_x + column, (_page + page) * 8, xors, length, rows);
+
+            span = reader.get_position();
+        }
+    }
+
+}    // namespace ssd1306_pico
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    inline constexpr uint8_t MAX_BITMAP_SCALE = 4;
+
+    // every bit of the index repeated SCALE times, so a page byte turns into the 8 * SCALE rows of its
+    // upscaled column with a single lookup
+    template<uint8_t SCALE>
+    struct BitSpreadTable
+    {
+        uint32_t values[256];
+    };
+
+    template<uint8_t SCALE>
+    constexpr BitSpreadTable<SCALE> make_bit_spread_table()
+    {
+        static_assert(SCALE >= 1 && SCALE <= MAX_BITMAP_SCALE, "spread bytes have to fit in 32 bits");
+
+        BitSpreadTable<SCALE> table = {};
+
+        for (uint16_t bits = 0; bits < 256; bits++)
+        {
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                if (bits & (1 << bit))
+                    table.values[bits] |= ((1u << SCALE) - 1) << (bit * SCALE);
+            }
+        }
+
+        return table;
+    }
+
+    template<uint8_t SCALE>
+    inline constexpr BitSpreadTable<SCALE> BIT_SPREAD_TABLE = make_bit_spread_table<SCALE>();
+
+    [[nodiscard]] constexpr uint32_t spread_bits(uint8_t bits, uint8_t scale)
+    {
+        switch (scale)
+        {
+        case 2:
+            return BIT_SPREAD_TABLE<2>.values[bits];
+        case 3:
+            return BIT_SPREAD_TABLE<3>.values[bits];
+        case 4:
+            return BIT_SPREAD_TABLE<4>.values[bits];
+        default:
+            return bits;
+        }
+    }
+
+}    // namespace ssd1306_pico
@@ -1,22 +1,36 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 
 namespace ssd1306_pico {
 class Bitmap {
 public:
-  Bitmap(uint8_t width, uint8_t height, bool filled = false);
-  Bitmap(uint8_t width, uint8_t height, const uint8_t *data);
-  Bitmap(const Bitmap &bitmap);
-  Bitmap(Bitmap &&bitmap) = default;
+  // views page-major data without copying it, so fonts and images can stay in
+  // flash and be used in constant expressions. the data has to outlive the
+  // bitmap
+  constexpr Bitmap(uint8_t width, uint8_t height, const uint8_t *data)
+      : _width(width), _height(height), _data(data) {}
+
+  // draws into a caller-owned buffer of get_buffer_size(width, height) bytes,
+  // which has to outlive the bitmap. nothing is ever allocated
+  Bitmap(uint8_t width, uint8_t height, uint8_t *buffer, bool filled);
+
+  // copies share the data
+  constexpr Bitmap(const Bitmap &bitmap) = default;
+  constexpr Bitmap(Bitmap &&bitmap) = default;
   Bitmap &operator=(const Bitmap &bitmap) = delete;
   Bitmap &operator=(Bitmap &&bitmap) = delete;
-  ~Bitmap();
+  constexpr ~Bitmap() = default;
 
-  [[nodiscard]] const uint8_t *get_data() const;
-  [[nodiscard]] uint8_t get_width() const;
-  [[nodiscard]] uint8_t get_height() const;
+  [[nodiscard]] static constexpr uint16_t get_buffer_size(uint8_t width,
+                                                          uint8_t height);
 
+  [[nodiscard]] constexpr const uint8_t *get_data() const;
+  [[nodiscard]] constexpr uint8_t get_width() const;
+  [[nodiscard]] constexpr uint8_t get_height() const;
+
+  // only change bitmaps made with a writable buffer
   void fill();
   void clear();
   void draw_pixel(uint8_t x, uint8_t y);
@@ -25,6 +39,35 @@ public:
 private:
   uint8_t _width;
   uint8_t _height;
-  uint8_t *_data;
+  const uint8_t *_data;
+
+  // set when the bitmap can be drawn into, _data points at it
+  uint8_t *_buffer = nullptr;
 };
-} // namespace ssd1306_pico
\ No newline at end of file
+
+// a bitmap that carries its own buffer, for drawing into at runtime without a
+// heap. it can't be copied, copies of it as a Bitmap view its buffer
+template <uint8_t WIDTH, uint8_t HEIGHT> class BitmapBuffer : public Bitmap {
+public:
+  BitmapBuffer(bool filled = false) : Bitmap(WIDTH, HEIGHT, _storage, filled) {}
+  BitmapBuffer(const BitmapBuffer &bitmap) = delete;
+  BitmapBuffer(BitmapBuffer &&bitmap) = delete;
+  BitmapBuffer &operator=(const BitmapBuffer &bitmap) = delete;
+  BitmapBuffer &operator=(BitmapBuffer &&bitmap) = delete;
+  ~BitmapBuffer() = default;
+
+private:
+  // filled or cleared by the Bitmap constructor, so no initializer here
+  uint8_t _storage[get_buffer_size(WIDTH, HEIGHT)];
+};
+
+constexpr uint16_t Bitmap::get_buffer_size(uint8_t width, uint8_t height) {
+  return width * ((height + 7) / 8);
+}
+
+constexpr const uint8_t *Bitmap::get_data() const { return _data; }
+
+constexpr uint8_t Bitmap::get_width() const { return _width; }
+
+constexpr uint8_t Bitmap::get_height() const { return _height; }
+} // namespace ssd1306_pico
@@ -0,0 +1,151 @@
+#include "code128.hpp"
+
+namespace ssd1306_pico
+{
+    namespace
+    {
+        // bars and spaces of every symbol value, 11 modules with the first bar in the top bit
+        constexpr uint16_t PATTERNS[106] = {
+            0b11011001100, 0b11001101100, 0b11001100110, 0b10010011000, 0b10010001100, 0b10001001100,
+            0b10011001000, 0b10011000100, 0b10001100100, 0b11001001000, 0b11001000100, 0b11000100100,
+            0b10110011100, 0b10011011100, 0b10011001110, 0b10111001100, 0b10011101100, 0b10011100110,
+            0b11001110010, 0b11001011100, 0b11001001110, 0b11011100100, 0b11001110100, 0b11101101110,
+            0b11101001100, 0b11100101100, 0b11100100110, 0b11101100100, 0b11100110100, 0b11100110010,
+            0b11011011000, 0b11011000110, 0b11000110110, 0b10100011000, 0b10001011000, 0b10001000110,
+            0b10110001000, 0b10001101000, 0b10001100010, 0b11010001000, 0b11000101000, 0b11000100010,
+            0b10110111000, 0b10110001110, 0b10001101110, 0b10111011000, 0b10111000110, 0b10001110110,
+            0b11101110110, 0b11010001110, 0b11000101110, 0b11011101000, 0b11011100010, 0b11011101110,
+            0b11101011000, 0b11101000110, 0b11100010110, 0b11101101000, 0b11101100010, 0b11100011010,
+            0b11101111010, 0b11001000010, 0b11110001010, 0b10100110000, 0b10100001100, 0b10010110000,
+            0b10010000110, 0b10000101100, 0b10000100110, 0b10110010000, 0b10110000100, 0b10011010000,
+            0b10011000010, 0b10000110100, 0b10000110010, 0b11000010010, 0b11001010000, 0b11110111010,
+            0b11000010100, 0b10001111010, 0b10100111100, 0b10010111100, 0b10010011110, 0b10111100100,
+            0b10011110100, 0b10011110010, 0b11110100100, 0b11110010100, 0b11110010010, 0b11011011110,
+            0b11011110110, 0b11110110110, 0b10101111000, 0b10100011110, 0b10001011110, 0b10111101000,
+            0b10111100010, 0b11110101000, 0b11110100010, 0b10111011110, 0b10111101110, 0b11101011110,
+            0b11110101110, 0b11010000100, 0b11010010000, 0b11010011100,
+        };
+
+        // the stop symbol is the only one 13 modules wide, it ends in a final bar
+        constexpr uint16_t STOP_PATTERN = 0b1100011101011;
+
+        constexpr uint8_t CODE_C  = 99;
+        constexpr uint8_t CODE_B  = 100;
+        constexpr uint8_t START_B = 104;
+        constexpr uint8_t START_C = 105;
+
+        constexpr uint8_t SYMBOL_MODULES = 11;
+
+        uint8_t count_digits(etl::string_view text, size_t start)
+        {
+            uint8_t count = 0;
+
+            while (start + count < text.size() && count < UINT8_MAX && text[start + count] >= '0' && text[start + count] <= '9')
+                count++;
+
+            return count;
+        }
+    }    // namespace
+
+    bool Code128::encode(etl::string_view text)
+    {
+        _length = 0;
+
+        for (char character : text)
+        {
+            if (static_cast<uint8_t>(character) < ' ' || static_cast<uint8_t>(character) > 127)
+                return false;
+        }
+
+        // switching to code set C and back costs a symbol each and every pair of digits saves one, so it
+        // pays off for 2 digits on their own, 4 at either end and 6 in between
+        auto pays_off = [&](size_t start, uint8_t digits) {
+            bool at_start = start == 0;
+            bool at_end   = start + digits == text.size();
+            return digits >= (at_start && at_end ? 2 : at_start || at_end ? 4 : 6);
+        };
+
+        bool set_c = pays_off(0, count_digits(text, 0));
+        _push(set_c ? START_C : START_B);
+
+        size_t position = 0;
+        while (position < text.size())
+        {
+            uint8_t digits = count_digits(text, position);
+
+            if (set_c)
+            {
+                if (digits >= 2)
+                {
+                    if (!_push((text[position] - '0') * 10 + text[position + 1] - '0'))
+                        return false;
+
+                    position += 2;
+                    continue;
+                }
+
+                if (!_push(CODE_B))
+                    return false;
+
+                set_c = false;
+            }
+
+            // an odd run starts with one digit in code set B
+            if (pays_off(position, digits))
+            {
+                if (digits % 2 != 0 && !_push(text[position++] - ' '))
+                    return false;
+
+                if (!_push(CODE_C))
+                    return false;
+
+                set_c = true;
+                continue;
+            }
+
+            if (!_push(text[position++] - ' '))
+                return false;
+        }
+
+        // weighted by position, the start symbol counting once
+        uint32_t checksum = _symbols[0];
+        for (uint8_t i = 1; i < _length; i++)
+            checksum += i * _symbols[i];
+
+        if (!_push(checksum % 103))
+            return false;
+
+        return true;
+    }
+
+    uint16_t Code128::get_width() const
+    {
+        if (_length == 0)
+            return 0;
+
+        return _length * SYMBOL_MODULES + 13;
+    }
+
+    bool Code128::is_bar(uint16_t module) const
+    {
+        uint16_t symbol = module / SYMBOL_MODULES;
+
+        if (symbol < _length)
+            return (PATTERNS[_symbols[symbol]] >> (SYMBOL_MODULES - 1 - module % SYMBOL_MODULES)) & 1;
+
+        return (STOP_PATTERN >> (12 - (module - _length * SYMBOL_MODULES))) & 1;
+    }
+
+    bool Code128::_push(uint8_t symbol)
+    {
+        // the stop symbol isn't stored, but the last slot is kept for it
+        if (_length + 1 >= MAX_CODE128_SYMBOLS)
+        {
+            _length = 0;
+            return false;
+        }
+
+        _symbols[_length++] = symbol;
+        return true;
+    }
+}    // namespace ssd1306_pico
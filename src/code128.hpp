@@ -0,0 +1,83 @@
+#pragma once
+
+#include "framebuffer.hpp"
+
+#include "etl/string_view.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // symbols a Code128 holds, start, checksum and stop included. at 11 modules each that's already wider
+    // than any screen
+    inline constexpr uint8_t MAX_CODE128_SYMBOLS = 24;
+
+    // Code 128 barcode of printable ASCII. digit runs are packed two to a symbol in code set C where that
+    // makes the code shorter, everything else uses code set B
+    class Code128
+    {
+    public:
+        Code128()                                  = default;
+        Code128(const Code128& code128)            = default;
+        Code128(Code128&& code128)                 = default;
+        Code128& operator=(const Code128& code128) = default;
+        Code128& operator=(Code128&& code128)      = default;
+        ~Code128()                                 = default;
+
+        // false for control characters, bytes past 127 or text that takes more than MAX_CODE128_SYMBOLS
+        bool encode(etl::string_view text);
+
+        // in modules, without the quiet zone. 0 before a successful encode
+        [[nodiscard]] uint16_t get_width() const;
+        [[nodiscard]] bool is_bar(uint16_t module) const;
+
+        // every module is a column scale pixels wide, with quiet_zone light modules on either side. bars are
+        // drawn as unlit pixels on a lit background, the way readers expect them, unless inverted
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t height, uint8_t scale = 1, uint8_t quiet_zone = 10, bool inverted = false) const;
+
+    private:
+        bool _push(uint8_t symbol);
+
+    private:
+        uint8_t _symbols[MAX_CODE128_SYMBOLS] = {};
+        uint8_t _length                       = 0;
+    };
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void Code128::draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t height, uint8_t scale, uint8_t quiet_zone, bool inverted) const
+    {
+        if (_length == 0 || scale == 0)
+            return;
+
+        const int16_t modules = get_width() + 2 * quiet_zone;
+
+        // only the columns and strips the clip lets through are built, starting at first when the code hangs
+        // off the left of it
+        int16_t start_x = x;
+        int16_t start_y = y;
+        int16_t end_x   = x + modules * scale;
+        int16_t end_y   = y + height;
+
+        if (!framebuffer.get_visible_rect(start_x, start_y, end_x, end_y))
+            return;
+
+        const int16_t first = start_x - x;
+        const int16_t width = end_x - start_x;
+
+        // every bar runs the full height, so one set of page bytes does for every strip
+        uint8_t columns[WIDTH];
+
+        for (int16_t column = 0; column < width; column++)
+        {
+            int16_t module = (first + column) / scale - quiet_zone;
+            bool bar       = module >= 0 && module < get_width() && is_bar(module);
+
+            columns[column] = bar == inverted ? 0xFF : 0x00;
+        }
+
+        for (int16_t strip_y = (start_y - y) / 8 * 8; strip_y < end_y - y; strip_y += 8)
+            framebuffer.blit_strip(x + first, y + strip_y, columns, width, std::min<int16_t>(height - strip_y, 8));
+    }
+}    // namespace ssd1306_pico
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Page-major run-length encoding, a control byte is followed by either
+//   0x00 - 0x7F: (control + 1) literal bytes
+//   0x80 - 0xFF: one byte repeated (control - 0x80 + 2) times
+// the header has no pico dependencies so the encoder can be used from host tools
+
+namespace ssd1306_pico
+{
+    class RleReader
+    {
+    public:
+        constexpr RleReader(const uint8_t* data) : _data(data)
+        {
+        }
+
+        constexpr uint8_t next()
+        {
+            if (_remaining == 0)
+            {
+                uint8_t control = *_data++;
+
+                _is_run    = control & 0x80;
+                _remaining = _is_run ? (control & 0x7F) + 2 : control + 1;
+            }
+
+            _remaining--;
+
+            if (!_is_run)
+                return *_data++;
+
+            // the repeated byte is consumed together with the last copy
+            return _remaining == 0 ? *_data++ : *_data;
+        }
+
+        constexpr void skip(uint16_t count)
+        {
+            while (count > 0)
+            {
+                if (_remaining == 0)
+                {
+                    next();
+                    count--;
+                    continue;
+                }
+
+                uint16_t step = count < _remaining ? count : _remaining;
+
+                if (!_is_run)
+                    _data += step;
+                else if (step == _remaining)
+                    _data++;
+
+                _remaining -= step;
+                count -= step;
+            }
+        }
+
+        [[nodiscard]] constexpr const uint8_t* get_position() const
+        {
+            return _data;
+        }
+
+    private:
+        const uint8_t* _data;
+        uint8_t _remaining = 0;
+        bool _is_run       = false;
+    };
+
+    // returns the encoded size, or 0 if it doesn't fit in output_capacity
+    [[nodiscard]] constexpr size_t rle_encode(const uint8_t* input, size_t length, uint8_t* output, size_t output_capacity)
+    {
+        constexpr size_t MAX_LITERAL = 128;
+        constexpr size_t MAX_RUN     = 129;
+
+        size_t out_pos       = 0;
+        size_t literal_start = 0;
+        size_t literal_len   = 0;
+
+        auto flush_literal = [&]() -> bool {
+            if (literal_len == 0)
+                return true;
+            if (out_pos + literal_len + 1 > output_capacity)
+                return false;
+
+            output[out_pos++] = static_cast<uint8_t>(literal_len - 1);
+            for (size_t i = 0; i < literal_len; i++)
+                output[out_pos++] = input[literal_start + i];
+
+            literal_len = 0;
+            return true;
+        };
+
+        size_t pos = 0;
+        while (pos < length)
+        {
+            size_t run = 1;
+            while (pos + run < length && run < MAX_RUN && input[pos + run] == input[pos])
+                run++;
+
+            // a run of 2 only pays off when it doesn't split a literal
+            if (run >= 3 || (run == 2 && literal_len == 0))
+            {
+                if (!flush_literal() || out_pos + 2 > output_capacity)
+                    return 0;
+
+                output[out_pos++] = static_cast<uint8_t>(0x80 | (run - 2));
+                output[out_pos++] = input[pos];
+                pos += run;
+                continue;
+            }
+
+            if (literal_len == 0)
+                literal_start = pos;
+
+            literal_len++;
+            pos++;
+
+            if (literal_len == MAX_LITERAL && !flush_literal())
+                return 0;
+        }
+
+        if (!flush_literal())
+            return 0;
+
+        return out_pos;
+    }
+
+    // RLE compressed page-major bitmap, the data is not copied so it can stay in flash
+    class CompressedBitmap
+    {
+    public:
+        constexpr CompressedBitmap(uint8_t width, uint8_t height, const uint8_t* data) : _width(width), _height(height), _data(data)
+        {
+        }
+
+        [[nodiscard]] constexpr const uint8_t* get_data() const
+        {
+            return _data;
+        }
+
+        [[nodiscard]] constexpr uint8_t get_width() const
+        {
+            return _width;
+        }
+
+        [[nodiscard]] constexpr uint8_t get_height() const
+        {
+            return _height;
+        }
+
+    private:
+        uint8_t _width;
+        uint8_t _height;
+        const uint8_t* _data;
+    };
+
+}    // namespace ssd1306_pico
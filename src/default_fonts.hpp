@@ -4,7 +4,7 @@
 
 namespace ssd1306_pico {
 
-static uint8_t small_font_buffer[] = {
+inline constexpr uint8_t small_font_buffer[] = {
     0x1F, 0x11, 0x1F, 0x00, 0x1F, 0xD1, 0x1F, 0x00, 0xDF, 0x11, 0xDF, 0x00,
     0xDF, 0x91, 0xDF, 0x00, 0x9F, 0xD1, 0x5F, 0x00, 0x5F, 0x11, 0x9F, 0x00,
     0xDF, 0xD1, 0x1F, 0x00, 0x1F, 0xD1, 0x1F, 0x00, 0x1F, 0x91, 0x5F, 0x00,
@@ -37,7 +37,7 @@ static uint8_t small_font_buffer[] = {
     0x79, 0x70, 0x79, 0x00, 0x49, 0x30, 0x49, 0x00, 0x18, 0xA1, 0x78, 0x00,
     0x69, 0x79, 0x59, 0x00, 0x11, 0x6D, 0x45, 0x00, 0x00, 0x6C, 0x00, 0x00,
     0x45, 0x6D, 0x11, 0x00, 0x08, 0x0C, 0x04, 0x00, 0x7D, 0x7D, 0x7D, 0x00};
-static uint8_t medium_font_buffer[] = {
+inline constexpr uint8_t medium_font_buffer[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5f, 0x00, 0x00, 0x00, 0x07,
     0x00, 0x07, 0x00, 0x14, 0x7f, 0x14, 0x7f, 0x14, 0x24, 0x2a, 0x7f, 0x2a,
     0x12, 0x23, 0x13, 0x08, 0x64, 0x62, 0x36, 0x49, 0x55, 0x22, 0x50, 0x00,
@@ -79,7 +79,7 @@ static uint8_t medium_font_buffer[] = {
     0x08, 0x36, 0x41, 0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x41, 0x36,
     0x08, 0x00, 0x10, 0x08, 0x08, 0x10, 0x08};
 
-static uint8_t large_font_buffer[] = {
+inline constexpr uint8_t large_font_buffer[] = {
     0x0,  0xFE, 0xFF, 0x3,  0x3,  0x3,  0x3,  0xFF, 0xFE, 0x0,  0x0,  0x0,
     0x4,  0x6,  0xFF, 0xFF, 0x0,  0x0,  0x0,  0x0,  0x0,  0x3,  0x83, 0x83,
     0x83, 0x83, 0x83, 0xFF, 0xFE, 0x0,  0x0,  0x83, 0x83, 0x83, 0x83, 0x83,
@@ -106,10 +106,20 @@ static uint8_t large_font_buffer[] = {
     0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0xFE, 0x12, 0x12,
     0xC,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,  0x0,
 };
-static const Font small_font =
-    Font(4, 6, 32, 128, 24, Bitmap(128, 24, small_font_buffer), false);
-static const Font medium_font =
-    Font(5, 8, 0, 130, 32, Bitmap(130, 32, medium_font_buffer), false);
-static const Font large_font =
-    Font(10, 16, 0, 150, 16, Bitmap(150, 16, large_font_buffer), true);
+inline constexpr GlyphExtents<4, 6, 128, 24>
+    small_font_extents(small_font_buffer);
+inline constexpr GlyphExtents<5, 8, 130, 32>
+    medium_font_extents(medium_font_buffer);
+inline constexpr GlyphExtents<10, 16, 150, 16>
+    large_font_extents(large_font_buffer);
+
+inline constexpr Font small_font =
+    Font(4, 6, 32, 128, 24, Bitmap(128, 24, small_font_buffer), false,
+         small_font_extents.extents);
+inline constexpr Font medium_font =
+    Font(5, 8, 0, 130, 32, Bitmap(130, 32, medium_font_buffer), false,
+         medium_font_extents.extents);
+inline constexpr Font large_font =
+    Font(10, 16, 0, 150, 16, Bitmap(150, 16, large_font_buffer), true,
+         large_font_extents.extents);
 } // namespace ssd1306_pico
\ No newline at end of file
@@ -3,13 +3,51 @@
 #include "framebuffer.hpp"
 #include "register_defines.hpp"
 #include "ssd1306_config.hpp"
+#include "trace.hpp"
+#include "transpose.hpp"
 
 #include "hardware/i2c.h"
 #include "pico/stdlib.h"
 #include <algorithm>
+#include <bit>
 
 namespace ssd1306_pico
 {
+    struct BusHealth
+    {
+        uint32_t transactions      = 0;
+        uint32_t nacks             = 0;
+        uint32_t timeouts          = 0;
+        uint32_t retries           = 0;
+        uint32_t failures          = 0;    // transactions that ran out of retries
+        uint32_t bus_resets        = 0;
+        uint32_t reinitializations = 0;
+    };
+
+    // bit planes a grayscale image can be streamed as, 8 levels
+    inline constexpr uint8_t MAX_BIT_PLANES = 3;
+
+    struct StreamingStats
+    {
+        uint32_t frames            = 0;
+        uint32_t late_frames       = 0;    // sent after their slot in the cadence had already passed
+        uint32_t frames_per_second = 0;    // sustained over the last full second
+        uint32_t cycles_per_second = 0;    // whole gray images, about 60 is needed for them not to flicker
+    };
+
+    // one I2C controller and its pins, shared by the controller of every panel on the bus
+    inline void initialize_i2c_bus(i2c_inst_t* i2c_instance, uint8_t sda_pin, uint8_t scl_pin, uint32_t baudrate)
+    {
+        i2c_init(i2c_instance, baudrate);
+        gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+        gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+        gpio_pull_up(sda_pin);
+        gpio_pull_up(scl_pin);
+    }
+
+    // every transfer is bounded by a timeout and retried a few times, a timeout also resets the bus.
+    // once a transfer runs out of retries the panel is marked as failed and every call returns false right away
+    // until i2c_recovery_interval_us has passed, then the next call re-initializes it first
     template<uint8_t WIDTH, uint8_t HEIGHT>
     class DisplayController
     {
@@ -21,111 +59,434 @@ namespace ssd1306_pico
         DisplayController& operator=(DisplayController&& controller)      = delete;
         ~DisplayController()                                              = default;
 
-        void initialize();
-        void display_framebuffer(const FrameBuffer<WIDTH, HEIGHT>& framebuffer);
-        void set_invesion(bool inverted);
-        void set_dimming(bool dimmed);
-        void set_contrast(uint8_t contrast);
+        // the bool returns are false when the panel didn't take the whole transfer
+        void initialize_bus();
+        bool initialize();
+        bool display_framebuffer(const FrameBuffer<WIDTH, HEIGHT>& framebuffer);
+        bool display_framebuffer_page(const FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t page, uint8_t start_column, uint8_t end_column);
+        bool display_page(const uint8_t* page_data, uint8_t page, uint8_t start_column, uint8_t end_column);
+
+        // sends a whole page-major frame straight from memory, like a StaticScreen kept in flash
+        bool display_buffer(const uint8_t* data);
+
+        // portrait framebuffers for panels mounted at 90 or 270 degrees, transposed 8x8 blocks at a time while flushing
+        bool display_rotated_framebuffer(const FrameBuffer<HEIGHT, WIDTH>& framebuffer);
+        bool display_rotated_framebuffer_page(const FrameBuffer<HEIGHT, WIDTH>& framebuffer, uint8_t page, uint8_t start_column, uint8_t end_column);
+
+        // only sends the blocks under the portrait framebuffer's dirty spans, then clears them. a failed
+        // flush leaves them dirty so the next call sends them again
+        bool display_rotated_framebuffer_changes(FrameBuffer<HEIGHT, WIDTH>& framebuffer);
+
+        // 0 and 180 degrees and mirroring are done by the panel's segment remap and COM scan direction
+        bool set_rotation(Rotation rotation, bool mirrored = false);
+        bool set_invesion(bool inverted);
+        bool set_dimming(bool dimmed);
+        bool set_contrast(uint8_t contrast);
+
+        // oscillator frequency in the high nibble and the divide ratio less one in the low nibble, together
+        // they set how often the panel refreshes itself
+        bool set_display_clock(uint8_t display_clock);
+
+        // phase 2 in the high nibble and phase 1 in the low nibble, in display clocks. every row takes
+        // both phases plus 50 clocks
+        bool set_precharge(uint8_t precharge);
+
+        // Keeps the panel fed with the bit planes of a grayscale image, plane k being shown 2^k frames
+        // out of every 2^plane_count - 1, spread out so the heavier planes don't bunch up. Frames start
+        // frame_interval_us apart, or back to back with 0, and the panel's clock and precharge are raised
+        // so it refreshes faster than the frames arrive. The planes have to outlive the stream
+        bool start_streaming(const FrameBuffer<WIDTH, HEIGHT>* const* planes, uint8_t plane_count, uint32_t frame_interval_us = 0);
+        bool stop_streaming();
+
+        // sends the next frame once its slot has come, to be called as often as possible. false when the
+        // panel didn't take it or no stream is running
+        bool update_streaming();
+
+        [[nodiscard]] bool is_streaming() const;
+        [[nodiscard]] const StreamingStats& get_streaming_stats() const;
+
+        [[nodiscard]] const BusHealth& get_bus_health() const;
+        [[nodiscard]] bool has_failed() const;
 
     private:
-        void _send_command(uint8_t command);
-        void _send_data(const uint8_t* data, uint8_t length);
+        bool _send_init_sequence();
+        bool _send_command(uint8_t command);
+        bool _send_commands(const uint8_t* commands, uint8_t length);
+        bool _send_data(const uint8_t* data, uint8_t length);
+        bool _set_window(uint8_t start_column, uint8_t end_column, uint8_t start_page, uint8_t end_page);
+
+        bool _is_ready();
+        bool _write(const uint8_t* buffer, uint16_t length);
+        void _reset_bus();
 
     private:
         SSD1306Config _config;
         bool _is_external_vcc;
+
+        BusHealth _bus_health;
+        bool _has_failed          = false;
+        uint64_t _next_recovery_us = 0;
+
+        static constexpr uint8_t DEFAULT_DISPLAY_CLOCK = 0x80;
+
+        // the fastest oscillator undivided and the shortest precharge phases, well over twice the default
+        // refresh rate
+        static constexpr uint8_t STREAMING_DISPLAY_CLOCK = 0xF0;
+        static constexpr uint8_t STREAMING_PRECHARGE     = 0x11;
+
+        // kept so a re-initialization brings back whatever was tuned
+        uint8_t _display_clock = DEFAULT_DISPLAY_CLOCK;
+        uint8_t _precharge;
+
+        const FrameBuffer<WIDTH, HEIGHT>* _planes[MAX_BIT_PLANES] = {};
+        uint8_t _plane_count                                      = 0;
+        uint8_t _stream_frame                                     = 0;    // position in the cycle of frames
+        uint32_t _frame_interval_us                               = 0;
+        uint64_t _next_frame_us                                   = 0;
+
+        StreamingStats _streaming_stats;
+        uint32_t _window_frames   = 0;
+        uint64_t _window_start_us = 0;
     };
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    DisplayController<WIDTH, HEIGHT>::DisplayController(SSD1306Config config, bool external_vcc) : _config(std::move(config)), _is_external_vcc(external_vcc)
+    DisplayController<WIDTH, HEIGHT>::DisplayController(SSD1306Config config, bool external_vcc)
+        : _config(std::move(config)), _is_external_vcc(external_vcc), _precharge(external_vcc ? 0x22 : 0xF1)
     {
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::_send_command(uint8_t command)
+    bool DisplayController<WIDTH, HEIGHT>::_send_command(uint8_t command)
     {
         uint8_t control_and_cmd[2] = {0x80, command};
-        i2c_write_blocking(_config.i2c_instance, _config.i2c_address, control_and_cmd, 2, false);
+        return _write(control_and_cmd, 2);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::_send_commands(const uint8_t* commands, uint8_t length)
+    {
+        static constexpr size_t MAX_COMMANDS = 32;
+
+        // a single control byte with Co = 0 makes every following byte a command
+        uint8_t control_and_cmds[MAX_COMMANDS + 1] = {0x00};
+        length                                     = std::min<uint8_t>(length, MAX_COMMANDS);
+
+        std::copy(commands, commands + length, control_and_cmds + 1);
+        return _write(control_and_cmds, length + 1);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::_send_data(const uint8_t* data, uint8_t length)
+    {
+        // up to a whole page in one transaction, each costs a few bytes more on the wire
+        uint8_t control_and_data[WIDTH + 1] = {0x40};
+        length                              = std::min<uint8_t>(length, WIDTH);
+
+        std::copy(data, data + length, control_and_data + 1);
+        return _write(control_and_data, length + 1);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::_set_window(uint8_t start_column, uint8_t end_column, uint8_t start_page, uint8_t end_page)
+    {
+        // horizontal addressing mode, the window wraps after end_column and then after end_page, so all
+        // of it is one stream of bytes
+        const uint8_t addressing[6] = {
+            SSD1306_COLUMNADDR,
+            start_column,
+            static_cast<uint8_t>(end_column - 1),
+            SSD1306_PAGEADDR,
+            start_page,
+            static_cast<uint8_t>(end_page - 1),
+        };
+
+        return _send_commands(addressing, 6);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::_is_ready()
+    {
+        if (!_has_failed)
+            return true;
+
+        if (time_us_64() < _next_recovery_us)
+            return false;
+
+        // the panel may have lost power, so it gets the whole init sequence before anything else
+        _has_failed = false;
+        _bus_health.reinitializations++;
+
+        return _send_init_sequence();
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::_send_data(const uint8_t* data, uint8_t length)
+    bool DisplayController<WIDTH, HEIGHT>::_write(const uint8_t* buffer, uint16_t length)
     {
-        static constexpr size_t MAX_I2C_TRANSFER              = 64;
-        static uint8_t CONTROL_AND_DATA[MAX_I2C_TRANSFER + 1] = {0x40};
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::_write");
+        if (_has_failed)
+            return false;
+
+        // 9 clocks per byte on the wire
+        uint32_t timeout_us = _config.i2c_timeout_us + (length * 9ull * 1000 * 1000) / _config.i2c_baudrate;
+
+        for (uint8_t attempt = 0; attempt <= _config.i2c_max_retries; attempt++)
+        {
+            if (attempt > 0)
+                _bus_health.retries++;
+
+            _bus_health.transactions++;
+            int result = i2c_write_timeout_us(_config.i2c_instance, _config.i2c_address, buffer, length, false, timeout_us);
+
+            if (result == length)
+                return true;
+
+            if (result == PICO_ERROR_TIMEOUT)
+            {
+                // usually a slave holding SDA low after an interrupted transfer
+                _bus_health.timeouts++;
+                _reset_bus();
+            }
+            else
+            {
+                _bus_health.nacks++;
+            }
+        }
+
+        _bus_health.failures++;
+        _has_failed       = true;
+        _next_recovery_us = time_us_64() + _config.i2c_recovery_interval_us;
+
+        return false;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void DisplayController<WIDTH, HEIGHT>::_reset_bus()
+    {
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::_reset_bus");
+        static constexpr uint32_t HALF_CLOCK_US = 5;
+
+        // the pins are driven as open drain by switching between a low output and a pulled up input
+        i2c_deinit(_config.i2c_instance);
+        gpio_set_function(_config.sda_pin, GPIO_FUNC_SIO);
+        gpio_set_function(_config.scl_pin, GPIO_FUNC_SIO);
+        gpio_put(_config.sda_pin, false);
+        gpio_put(_config.scl_pin, false);
+        gpio_set_dir(_config.sda_pin, GPIO_IN);
+        gpio_set_dir(_config.scl_pin, GPIO_IN);
+
+        // up to 9 clocks let a slave finish the byte it's stuck in and release SDA
+        for (uint8_t i = 0; i < 9 && !gpio_get(_config.sda_pin); i++)
+        {
+            gpio_set_dir(_config.scl_pin, GPIO_OUT);
+            sleep_us(HALF_CLOCK_US);
+            gpio_set_dir(_config.scl_pin, GPIO_IN);
+            sleep_us(HALF_CLOCK_US);
+        }
+
+        // then a STOP, SDA rising while SCL is high
+        gpio_set_dir(_config.scl_pin, GPIO_OUT);
+        gpio_set_dir(_config.sda_pin, GPIO_OUT);
+        sleep_us(HALF_CLOCK_US);
+        gpio_set_dir(_config.scl_pin, GPIO_IN);
+        sleep_us(HALF_CLOCK_US);
+        gpio_set_dir(_config.sda_pin, GPIO_IN);
+        sleep_us(HALF_CLOCK_US);
 
-        std::copy(data, data + length, CONTROL_AND_DATA + 1);
+        // a shared bus comes back at this panel's baudrate
+        initialize_bus();
+        _bus_health.bus_resets++;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void DisplayController<WIDTH, HEIGHT>::initialize_bus()
+    {
+        initialize_i2c_bus(_config.i2c_instance, _config.sda_pin, _config.scl_pin, _config.i2c_baudrate);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::initialize()
+    {
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::initialize");
+        if (_config.initialize_bus)
+            initialize_bus();
+
+        _has_failed = false;
+
+        return _send_init_sequence();
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::_send_init_sequence()
+    {
+        const uint8_t init_sequence[] = {
+            SSD1306_DISPLAYOFF,            // 0xAE
+            SSD1306_SETDISPLAYCLOCKDIV,    // 0xD5
+            _display_clock,                // the suggested ratio 0x80 unless tuned
+            SSD1306_SETMULTIPLEX,          // 0xA8
+            0x3F,
+            SSD1306_SETDISPLAYOFFSET,      // 0xD3
+            0x0,                           // no offset
+            SSD1306_SETSTARTLINE | 0x0,    // line #0
+            SSD1306_CHARGEPUMP,            // 0x8D
+            static_cast<uint8_t>(_is_external_vcc ? 0x10 : 0x14),
+
+            SSD1306_MEMORYMODE,    // 0x20
+            0x00,                  // 0x0 horizontal addressing
+            SSD1306_SETCOMPINS,    // 0xDA
+            0x12,
+            SSD1306_SETCONTRAST,    // 0x81
+            static_cast<uint8_t>(_is_external_vcc ? 0x9F : 0xCF),
+            SSD1306_SETPRECHARGE,    // 0xd9
+            _precharge,
+            SSD1306_SETVCOMDETECT,    // 0xDB
+            0x40,
+
+            SSD1306_DEACTIVATE_SCROLL,      // 0x2E
+            SSD1306_DISPLAYALLON_RESUME,    // 0xA4
+            SSD1306_NORMALDISPLAY,          // 0xA6
+        };
+
+        // sent as one transaction, so a missing panel costs a single bounded write
+        return _send_commands(init_sequence, sizeof(init_sequence)) && set_rotation(_config.rotation, _config.mirrored) && _send_command(SSD1306_DISPLAYON);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::display_framebuffer(const FrameBuffer<WIDTH, HEIGHT>& framebuffer)
+    {
+        return display_buffer(framebuffer.get_data());
+    }
 
-        i2c_write_blocking(_config.i2c_instance, _config.i2c_address, CONTROL_AND_DATA, length + 1, false);
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::display_framebuffer_page(const FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t page, uint8_t start_column, uint8_t end_column)
+    {
+        return display_page(framebuffer.get_data() + page * WIDTH, page, start_column, end_column);
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::initialize()
+    bool DisplayController<WIDTH, HEIGHT>::display_page(const uint8_t* page_data, uint8_t page, uint8_t start_column, uint8_t end_column)
     {
-        i2c_init(_config.i2c_instance, 400 * 1000);
-        gpio_set_function(PICO_DEFAULT_I2C_SDA_PIN, GPIO_FUNC_I2C);
-        gpio_set_function(PICO_DEFAULT_I2C_SCL_PIN, GPIO_FUNC_I2C);
-        gpio_pull_up(PICO_DEFAULT_I2C_SDA_PIN);
-        gpio_pull_up(PICO_DEFAULT_I2C_SCL_PIN);
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::display_page");
+        if (start_column >= end_column)
+            return true;
+
+        if (!_is_ready())
+            return false;
 
-        _send_command(SSD1306_DISPLAYOFF);            // 0xAE
-        _send_command(SSD1306_SETDISPLAYCLOCKDIV);    // 0xD5
-        _send_command(0x80);                          // the suggested ratio 0x80
-        _send_command(SSD1306_SETMULTIPLEX);          // 0xA8
-        _send_command(0x3F);
-        _send_command(SSD1306_SETDISPLAYOFFSET);      // 0xD3
-        _send_command(0x0);                           // no offset
-        _send_command(SSD1306_SETSTARTLINE | 0x0);    // line #0
-        _send_command(SSD1306_CHARGEPUMP);            // 0x8D
-        _send_command(_is_external_vcc ? 0x10 : 0x14);
+        return _set_window(start_column, end_column, page, page + 1) && _send_data(page_data + start_column, end_column - start_column);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::display_buffer(const uint8_t* data)
+    {
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::display_buffer");
+        if (!_is_ready())
+            return false;
 
-        _send_command(SSD1306_MEMORYMODE);        // 0x20
-        _send_command(0x00);                      // 0x0 horizontal addressing
-        _send_command(SSD1306_SEGREMAP | 0x1);    // 0xA0
-        _send_command(SSD1306_COMSCANDEC);        // 0xC8
-        _send_command(SSD1306_SETCOMPINS);        // 0xDA
-        _send_command(0x12);
-        _send_command(SSD1306_SETCONTRAST);    // 0x81
-        _send_command(_is_external_vcc ? 0x9F : 0xCF);
-        _send_command(SSD1306_SETPRECHARGE);    // 0xd9
-        _send_command(_is_external_vcc ? 0x22 : 0xF1);
-        _send_command(SSD1306_SETVCOMDETECT);    // 0xDB
-        _send_command(0x40);
+        // one window for the whole frame and then a transaction per page
+        if (!_set_window(0, WIDTH, 0, HEIGHT / 8))
+            return false;
 
-        _send_command(SSD1306_DEACTIVATE_SCROLL);      // 0x2E
-        _send_command(SSD1306_DISPLAYALLON_RESUME);    // 0xA4
-        _send_command(SSD1306_NORMALDISPLAY);          // 0xA6
+        for (uint8_t page = 0; page < HEIGHT / 8; page++)
+        {
+            if (!_send_data(data + page * WIDTH, WIDTH))
+                return false;
+        }
 
-        _send_command(SSD1306_DISPLAYON);
+        return true;
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::display_framebuffer(const FrameBuffer<WIDTH, HEIGHT>& framebuffer)
+    bool DisplayController<WIDTH, HEIGHT>::display_rotated_framebuffer(const FrameBuffer<HEIGHT, WIDTH>& framebuffer)
     {
-        const uint8_t* data = framebuffer.get_data();
+        for (uint8_t page = 0; page < HEIGHT / 8; page++)
+        {
+            if (!display_rotated_framebuffer_page(framebuffer, page, 0, WIDTH))
+                return false;
+        }
 
-        for (uint8_t page = 0; page < 8; page++)
+        return true;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::display_rotated_framebuffer_changes(FrameBuffer<HEIGHT, WIDTH>& framebuffer)
+    {
+        // the framebuffer's page p becomes panel columns p * 8.. and its columns x become panel page x / 8,
+        // so every panel page gets the blocks of the framebuffer pages dirty within its 8 columns
+        for (uint8_t page = 0; page < HEIGHT / 8; page++)
         {
-            _send_command(0x10);           // set higher column address
-            _send_command(0x00);           // set lower column address
-            _send_command(0xB0 + page);    // set page address
+            uint8_t start_column = WIDTH;
+            uint8_t end_column   = 0;
 
-            _send_data(data + page * WIDTH, 64);
-            _send_data(data + page * WIDTH + 64, 64);
+            for (uint8_t block = 0; block < WIDTH / 8; block++)
+            {
+                if (!framebuffer.is_dirty(block) || framebuffer.get_dirty_start(block) >= page * 8 + 8 || framebuffer.get_dirty_end(block) <= page * 8)
+                    continue;
+
+                start_column = std::min<uint8_t>(start_column, block * 8);
+                end_column   = block * 8 + 8;
+            }
+
+            if (start_column < end_column && !display_rotated_framebuffer_page(framebuffer, page, start_column, end_column))
+                return false;
         }
+
+        framebuffer.clear_dirty();
+        return true;
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::set_invesion(bool inverted)
+    bool DisplayController<WIDTH, HEIGHT>::display_rotated_framebuffer_page(const FrameBuffer<HEIGHT, WIDTH>& framebuffer, uint8_t page, uint8_t start_column, uint8_t end_column)
     {
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::display_rotated_framebuffer_page");
+        uint8_t page_data[WIDTH];
+
+        // panel column x of this page holds framebuffer rows page * 8.. at framebuffer column x, so every
+        // 8 columns are one 8x8 block of the framebuffer's page x / 8 transposed
+        for (uint16_t block = start_column / 8; block * 8 < end_column; block++)
+            transpose_8x8(framebuffer.get_data() + block * HEIGHT + page * 8, page_data + block * 8);
+
+        return display_page(page_data, page, start_column, end_column);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::set_rotation(Rotation rotation, bool mirrored)
+    {
+        if (!_is_ready())
+            return false;
+
+        // the panel draws column 0 on the right and page 0 at the bottom unless remapped. rotating by 90
+        // is a transpose plus one flip, 270 the transpose plus the other
+        bool remap_segments = rotation == Rotation::ROTATE_0 || rotation == Rotation::ROTATE_270;
+        bool scan_reversed  = rotation == Rotation::ROTATE_0 || rotation == Rotation::ROTATE_90;
+
+        // left to right is along the segments upright and along the COM lines on its side
+        if (mirrored && (rotation == Rotation::ROTATE_0 || rotation == Rotation::ROTATE_180))
+            remap_segments = !remap_segments;
+        else if (mirrored)
+            scan_reversed = !scan_reversed;
+
+        const uint8_t commands[2] = {
+            static_cast<uint8_t>(SSD1306_SEGREMAP | (remap_segments ? 0x1 : 0x0)),    // 0xA0
+            static_cast<uint8_t>(scan_reversed ? SSD1306_COMSCANDEC : SSD1306_COMSCANINC),
+        };
+
+        return _send_commands(commands, 2);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::set_invesion(bool inverted)
+    {
+        if (!_is_ready())
+            return false;
+
         if (inverted)
-            _send_command(SSD1306_INVERTDISPLAY);
+            return _send_command(SSD1306_INVERTDISPLAY);
         else
-            _send_command(SSD1306_NORMALDISPLAY);
+            return _send_command(SSD1306_NORMALDISPLAY);
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::set_dimming(bool dimmed)
+    bool DisplayController<WIDTH, HEIGHT>::set_dimming(bool dimmed)
     {
         uint8_t contrast;
 
@@ -134,15 +495,135 @@ namespace ssd1306_pico
         else
             contrast = _is_external_vcc ? 0x9F : 0xCF;
 
-        _send_command(SSD1306_SETCONTRAST);
-        _send_command(contrast);
+        return set_contrast(contrast);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::set_contrast(uint8_t contrast)
+    {
+        if (!_is_ready())
+            return false;
+
+        const uint8_t commands[2] = {SSD1306_SETCONTRAST, contrast};
+        return _send_commands(commands, 2);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::set_display_clock(uint8_t display_clock)
+    {
+        _display_clock = display_clock;
+
+        if (!_is_ready())
+            return false;
+
+        const uint8_t commands[2] = {SSD1306_SETDISPLAYCLOCKDIV, display_clock};
+        return _send_commands(commands, 2);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::set_precharge(uint8_t precharge)
+    {
+        _precharge = precharge;
+
+        if (!_is_ready())
+            return false;
+
+        const uint8_t commands[2] = {SSD1306_SETPRECHARGE, precharge};
+        return _send_commands(commands, 2);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::start_streaming(const FrameBuffer<WIDTH, HEIGHT>* const* planes, uint8_t plane_count, uint32_t frame_interval_us)
+    {
+        if (plane_count == 0 || plane_count > MAX_BIT_PLANES)
+            return false;
+
+        std::copy(planes, planes + plane_count, _planes);
+        _plane_count       = plane_count;
+        _stream_frame      = 0;
+        _frame_interval_us = frame_interval_us;
+        _next_frame_us     = time_us_64();
+
+        _streaming_stats = {};
+        _window_frames   = 0;
+        _window_start_us = _next_frame_us;
+
+        return set_display_clock(STREAMING_DISPLAY_CLOCK) && set_precharge(STREAMING_PRECHARGE);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::stop_streaming()
+    {
+        _plane_count = 0;
+
+        return set_display_clock(DEFAULT_DISPLAY_CLOCK) && set_precharge(_is_external_vcc ? 0x22 : 0xF1);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::update_streaming()
+    {
+        SSD1306_PICO_TRACE_SCOPE("DisplayController::update_streaming");
+        if (_plane_count == 0)
+            return false;
+
+        uint64_t now_us = time_us_64();
+        if (now_us < _next_frame_us)
+            return true;
+
+        if (_frame_interval_us > 0 && now_us >= _next_frame_us + _frame_interval_us)
+            _streaming_stats.late_frames++;
+
+        // frames 1 to 2^n - 1 of a cycle, frame i shows the plane its trailing zeros count down to from
+        // the top one. for 3 planes that's 2 1 2 0 2 1 2
+        const uint8_t cycle_length = (1 << _plane_count) - 1;
+
+        _stream_frame = _stream_frame % cycle_length + 1;
+        uint8_t plane = _plane_count - 1 - std::countr_zero(_stream_frame);
+
+        // a frame that runs late pushes the cadence back instead of the next ones bunching up to catch up
+        _next_frame_us = std::max(_next_frame_us + _frame_interval_us, now_us);
+
+        if (!display_buffer(_planes[plane]->get_data()))
+            return false;
+
+        _streaming_stats.frames++;
+        _window_frames++;
+
+        uint64_t elapsed_us = time_us_64() - _window_start_us;
+        if (elapsed_us >= 1000 * 1000)
+        {
+            _streaming_stats.frames_per_second = _window_frames * 1000ull * 1000 / elapsed_us;
+            _streaming_stats.cycles_per_second = _streaming_stats.frames_per_second / cycle_length;
+
+            _window_frames = 0;
+            _window_start_us += elapsed_us;
+        }
+
+        return true;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    bool DisplayController<WIDTH, HEIGHT>::is_streaming() const
+    {
+        return _plane_count > 0;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    const StreamingStats& DisplayController<WIDTH, HEIGHT>::get_streaming_stats() const
+    {
+        return _streaming_stats;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    const BusHealth& DisplayController<WIDTH, HEIGHT>::get_bus_health() const
+    {
+        return _bus_health;
     }
 
     template<uint8_t WIDTH, uint8_t HEIGHT>
-    void DisplayController<WIDTH, HEIGHT>::set_contrast(uint8_t contrast)
+    bool DisplayController<WIDTH, HEIGHT>::has_failed() const
     {
-        _send_command(SSD1306_SETCONTRAST);
-        _send_command(contrast);
+        return _has_failed;
     }
 
 }    // namespace ssd1306_pico
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "bitmap.hpp"
+#include "compressed_bitmap.hpp"
+#include "framebuffer.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace ssd1306_pico
+{
+    // Records the FrameBuffer drawing calls into a compact byte stream instead of rasterizing them, replay()
+    // then rasterizes one page at a time into a WIDTH x 8 page buffer. bitmaps are stored by pointer,
+    // so they have to outlive the list until the next clear() or fill()
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    class DisplayList
+    {
+    public:
+        DisplayList(bool filled = false);
+        DisplayList(const DisplayList& display_list)            = delete;
+        DisplayList(DisplayList&& display_list)                 = delete;
+        DisplayList& operator=(const DisplayList& display_list) = delete;
+        DisplayList& operator=(DisplayList&& display_list)      = delete;
+        ~DisplayList()                                          = default;
+
+        void fill();
+        void clear();
+
+        void push_clip(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void push_translation(int16_t x, int16_t y);
+        void push_viewport(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void pop_clip();
+
+        void draw_pixel(int16_t x, int16_t y);
+        void erase_pixel(int16_t x, int16_t y);
+
+        void fill_rect(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void erase_rect(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void draw_line(int16_t start_x, int16_t start_y, int16_t end_x, int16_t end_y);
+        void fill_triangle(Point a, Point b, Point c);
+        void fill_polygon(const Point* points, uint8_t count);
+
+        void draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap, bool transparent = false);
+        void draw_scaled_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap, uint8_t scale, bool transparent = false);
+        void draw_compressed_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const CompressedBitmap& bitmap, bool transparent = false);
+
+        void replay(FrameBuffer<WIDTH, 8>& page_buffer, uint8_t page) const;
+
+        [[nodiscard]] bool is_dirty() const;
+        void clear_dirty();
+
+        [[nodiscard]] uint16_t get_size() const;
+        [[nodiscard]] uint16_t get_capacity() const;
+        [[nodiscard]] bool has_overflowed() const;
+
+    private:
+        enum class CommandType : uint8_t
+        {
+            FILL,
+            PUSH_CLIP,
+            PUSH_TRANSLATION,
+            PUSH_VIEWPORT,
+            POP_CLIP,
+            DRAW_PIXEL,
+            ERASE_PIXEL,
+            FILL_RECT,
+            ERASE_RECT,
+            DRAW_LINE,
+            FILL_POLYGON,
+            DRAW_BITMAP,
+            DRAW_COMPRESSED_BITMAP
+        };
+
+        struct BitmapArgs
+        {
+            int16_t x;
+            int16_t y;
+            uint8_t map_x;
+            uint8_t map_y;
+            uint8_t map_width;
+            uint8_t map_height;
+            const void* bitmap;
+            bool transparent;
+            uint8_t scale;
+        };
+
+        void _reset();
+        void _record(CommandType type, const void* args, uint8_t size);
+
+        template<typename T>
+        static T _read(const uint8_t*& position);
+
+    private:
+        uint8_t _commands[CAPACITY];
+        uint16_t _size = 0;
+
+        // pops without a recorded push are dropped so they can't unwind the page translation during replay
+        uint8_t _clip_depth = 0;
+
+        bool _is_dirty       = true;
+        bool _has_overflowed = false;
+    };
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    DisplayList<WIDTH, HEIGHT, CAPACITY>::DisplayList(bool filled)
+    {
+        if (filled)
+            fill();
+        else
+            clear();
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::fill()
+    {
+        _reset();
+        _record(CommandType::FILL, nullptr, 0);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::clear()
+    {
+        // every page starts out cleared, so an empty list is a cleared screen
+        _reset();
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::push_clip(int16_t x, int16_t y, uint8_t width, uint8_t height)
+    {
+        const int16_t args[3] = {x, y, static_cast<int16_t>(width | (height << 8))};
+        _record(CommandType::PUSH_CLIP, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::push_translation(int16_t x, int16_t y)
+    {
+        const int16_t args[2] = {x, y};
+        _record(CommandType::PUSH_TRANSLATION, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::push_viewport(int16_t x, int16_t y, uint8_t width, uint8_t height)
+    {
+        const int16_t args[3] = {x, y, static_cast<int16_t>(width | (height << 8))};
+        _record(CommandType::PUSH_VIEWPORT, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::pop_clip()
+    {
+        if (_clip_depth == 0)
+            return;
+
+        _record(CommandType::POP_CLIP, nullptr, 0);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::draw_pixel(int16_t x, int16_t y)
+    {
+        const int16_t args[2] = {x, y};
+        _record(CommandType::DRAW_PIXEL, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::erase_pixel(int16_t x, int16_t y)
+    {
+        const int16_t args[2] = {x, y};
+        _record(CommandType::ERASE_PIXEL, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::fill_rect(int16_t x, int16_t y, uint8_t width, uint8_t height)
+    {
+        const int16_t args[3] = {x, y, static_cast<int16_t>(width | (height << 8))};
+        _record(CommandType::FILL_RECT, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::erase_rect(int16_t x, int16_t y, uint8_t width, uint8_t height)
+    {
+        const int16_t args[3] = {x, y, static_cast<int16_t>(width | (height << 8))};
+        _record(CommandType::ERASE_RECT, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::draw_line(int16_t start_x, int16_t start_y, int16_t end_x, int16_t end_y)
+    {
+        const int16_t args[4] = {start_x, start_y, end_x, end_y};
+        _record(CommandType::DRAW_LINE, args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::fill_triangle(Point a, Point b, Point c)
+    {
+        const Point points[3] = {a, b, c};
+        fill_polygon(points, 3);
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::fill_polygon(const Point* points, uint8_t count)
+    {
+        // the vertices are copied inline after their count
+        if (count < 3 || count > MAX_POLYGON_VERTICES)
+            return;
+
+        uint8_t args[1 + MAX_POLYGON_VERTICES * sizeof(Point)];
+        args[0] = count;
+        std::memcpy(args + 1, points, count * sizeof(Point));
+
+        _record(CommandType::FILL_POLYGON, args, 1 + count * sizeof(Point));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap, bool transparent)
+    {
+        const BitmapArgs args = {x, y, map_x, map_y, map_width, map_height, &bitmap, transparent, 1};
+        _record(CommandType::DRAW_BITMAP, &args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::draw_scaled_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap, uint8_t scale, bool transparent)
+    {
+        const BitmapArgs args = {x, y, map_x, map_y, map_width, map_height, &bitmap, transparent, scale};
+        _record(CommandType::DRAW_BITMAP, &args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::draw_compressed_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const CompressedBitmap& bitmap, bool transparent)
+    {
+        const BitmapArgs args = {x, y, map_x, map_y, map_width, map_height, &bitmap, transparent, 1};
+        _record(CommandType::DRAW_COMPRESSED_BITMAP, &args, sizeof(args));
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::replay(FrameBuffer<WIDTH, 8>& page_buffer, uint8_t page) const
+    {
+        page_buffer.clear();
+        page_buffer.push_translation(0, -8 * page);
+
+        const uint8_t* position = _commands;
+        const uint8_t* end      = _commands + _size;
+
+        while (position < end)
+        {
+            CommandType type = static_cast<CommandType>(*position++);
+
+            switch (type)
+            {
+            case CommandType::FILL:
+                page_buffer.fill();
+                break;
+            case CommandType::PUSH_CLIP:
+            case CommandType::PUSH_VIEWPORT:
+            case CommandType::FILL_RECT:
+            case CommandType::ERASE_RECT: {
+                int16_t x   = _read<int16_t>(position);
+                int16_t y   = _read<int16_t>(position);
+                uint16_t wh = _read<int16_t>(position);
+                uint8_t w   = wh & 0xFF;
+                uint8_t h   = wh >> 8;
+
+                if (type == CommandType::PUSH_CLIP)
+                    page_buffer.push_clip(x, y, w, h);
+                else if (type == CommandType::PUSH_VIEWPORT)
+                    page_buffer.push_viewport(x, y, w, h);
+                else if (type == CommandType::FILL_RECT)
+                    page_buffer.fill_rect(x, y, w, h);
+                else
+                    page_buffer.erase_rect(x, y, w, h);
+                break;
+            }
+            case CommandType::PUSH_TRANSLATION:
+            case CommandType::DRAW_PIXEL:
+            case CommandType::ERASE_PIXEL: {
+                int16_t x = _read<int16_t>(position);
+                int16_t y = _read<int16_t>(position);
+
+                if (type == CommandType::PUSH_TRANSLATION)
+                    page_buffer.push_translation(x, y);
+                else if (type == CommandType::DRAW_PIXEL)
+                    page_buffer.draw_pixel(x, y);
+                else
+                    page_buffer.erase_pixel(x, y);
+                break;
+            }
+            case CommandType::POP_CLIP:
+                page_buffer.pop_clip();
+                break;
+            case CommandType::DRAW_LINE: {
+                int16_t start_x = _read<int16_t>(position);
+                int16_t start_y = _read<int16_t>(position);
+                int16_t end_x   = _read<int16_t>(position);
+                int16_t end_y   = _read<int16_t>(position);
+
+                page_buffer.draw_line(start_x, start_y, end_x, end_y);
+                break;
+            }
+            case CommandType::FILL_POLYGON: {
+                Point points[MAX_POLYGON_VERTICES];
+                uint8_t count = _read<uint8_t>(position);
+
+                for (uint8_t i = 0; i < count; i++)
+                    points[i] = _read<Point>(position);
+
+                page_buffer.fill_polygon(points, count);
+                break;
+            }
+            case CommandType::DRAW_BITMAP: {
+                BitmapArgs args = _read<BitmapArgs>(position);
+                page_buffer.draw_scaled_bitmap(args.x, args.y, args.map_x, args.map_y, args.map_width, args.map_height, *static_cast<const Bitmap*>(args.bitmap), args.scale, args.transparent);
+                break;
+            }
+            case CommandType::DRAW_COMPRESSED_BITMAP: {
+                BitmapArgs args = _read<BitmapArgs>(position);
+                page_buffer.draw_compressed_bitmap(args.x, args.y, args.map_x, args.map_y, args.map_width, args.map_height, *static_cast<const CompressedBitmap*>(args.bitmap), args.transparent);
+                break;
+            }
+            }
+        }
+
+        // unwind whatever the list left pushed, then the page translation
+        for (uint8_t i = 0; i <= _clip_depth; i++)
+            page_buffer.pop_clip();
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    bool DisplayList<WIDTH, HEIGHT, CAPACITY>::is_dirty() const
+    {
+        return _is_dirty;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::clear_dirty()
+    {
+        _is_dirty = false;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    uint16_t DisplayList<WIDTH, HEIGHT, CAPACITY>::get_size() const
+    {
+        return _size;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    uint16_t DisplayList<WIDTH, HEIGHT, CAPACITY>::get_capacity() const
+    {
+        return CAPACITY;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    bool DisplayList<WIDTH, HEIGHT, CAPACITY>::has_overflowed() const
+    {
+        return _has_overflowed;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::_reset()
+    {
+        _size           = 0;
+        _clip_depth     = 0;
+        _is_dirty       = true;
+        _has_overflowed = false;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    void DisplayList<WIDTH, HEIGHT, CAPACITY>::_record(CommandType type, const void* args, uint8_t size)
+    {
+        // a dropped push would leave its pop unmatched, so the overflow is latched until the next reset
+        if (_has_overflowed || _size + 1 + size > CAPACITY)
+        {
+            _has_overflowed = true;
+            return;
+        }
+
+        _commands[_size++] = static_cast<uint8_t>(type);
+        if (size > 0)
+            std::memcpy(_commands + _size, args, size);
+        _size += size;
+
+        if (type == CommandType::PUSH_CLIP || type == CommandType::PUSH_TRANSLATION || type == CommandType::PUSH_VIEWPORT)
+            _clip_depth++;
+        else if (type == CommandType::POP_CLIP)
+            _clip_depth--;
+
+        _is_dirty = true;
+    }
+
+    template<uint8_t WIDTH, uint8_t HEIGHT, uint16_t CAPACITY>
+    template<typename T>
+    T DisplayList<WIDTH, HEIGHT, CAPACITY>::_read(const uint8_t*& position)
+    {
+        T value;
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+
+        return value;
+    }
+
+}    // namespace ssd1306_pico
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "ssd1306_pico.hpp"
+
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // Owns the I2C controllers shared by several panels and interleaves their flushes one page at a time,
+    // so a full-frame update on one panel can't hold the bus for longer than a single page transfer
+    template<uint8_t MAX_DISPLAYS = 4>
+    class DisplayManager
+    {
+    public:
+        DisplayManager()                                         = default;
+        DisplayManager(const DisplayManager& manager)            = delete;
+        DisplayManager(DisplayManager&& manager)                 = delete;
+        DisplayManager& operator=(const DisplayManager& manager) = delete;
+        DisplayManager& operator=(DisplayManager&& manager)      = delete;
+        ~DisplayManager()                                        = default;
+
+        void initialize_bus(i2c_inst_t* i2c_instance, uint8_t sda_pin, uint8_t scl_pin, uint32_t baudrate = 400 * 1000);
+
+        // displays registered here should be created with SSD1306Config::initialize_bus = false
+        bool add_display(SSD1306& display, uint8_t priority = 0, uint32_t latency_budget_us = 50 * 1000);
+
+        // flushes dirty pages, most urgent panel first, until nothing is pending or time_budget_us is spent
+        void render(uint32_t time_budget_us);
+        void render();
+
+        [[nodiscard]] uint8_t get_display_count() const;
+
+    private:
+        struct ManagedDisplay
+        {
+            SSD1306* display;
+            uint8_t priority;
+            uint32_t latency_budget_us;
+            uint64_t pending_since_us;
+            bool is_pending;
+            bool is_skipped;    // failed a flush, left out for the rest of this render call
+        };
+
+        ManagedDisplay* _pick_next(uint64_t now_us);
+        void _clear_skipped();
+
+    private:
+        ManagedDisplay _displays[MAX_DISPLAYS] {};
+        uint8_t _display_count = 0;
+
+        bool _is_bus_initialized[2] = {false, false};
+    };
+
+    template<uint8_t MAX_DISPLAYS>
+    void DisplayManager<MAX_DISPLAYS>::initialize_bus(i2c_inst_t* i2c_instance, uint8_t sda_pin, uint8_t scl_pin, uint32_t baudrate)
+    {
+        uint bus_index = i2c_get_index(i2c_instance);
+
+        if (_is_bus_initialized[bus_index])
+            return;
+
+        initialize_i2c_bus(i2c_instance, sda_pin, scl_pin, baudrate);
+
+        _is_bus_initialized[bus_index] = true;
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    bool DisplayManager<MAX_DISPLAYS>::add_display(SSD1306& display, uint8_t priority, uint32_t latency_budget_us)
+    {
+        if (_display_count >= MAX_DISPLAYS)
+            return false;
+
+        _displays[_display_count++] = ManagedDisplay {
+            .display           = &display,
+            .priority          = priority,
+            .latency_budget_us = latency_budget_us,
+            .pending_since_us  = 0,
+            .is_pending        = false,
+            .is_skipped        = false,
+        };
+
+        return true;
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    void DisplayManager<MAX_DISPLAYS>::render(uint32_t time_budget_us)
+    {
+        uint64_t start_us = time_us_64();
+        uint64_t now_us   = start_us;
+
+        do
+        {
+            ManagedDisplay* next = _pick_next(now_us);
+            if (next == nullptr)
+                break;
+
+            if (next->display->render_page() == RenderResult::FAILED)
+                next->is_skipped = true;
+            if (!next->display->has_pending_updates())
+                next->is_pending = false;
+
+            now_us = time_us_64();
+        } while (now_us - start_us < time_budget_us);
+
+        _clear_skipped();
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    void DisplayManager<MAX_DISPLAYS>::render()
+    {
+        while (ManagedDisplay* next = _pick_next(time_us_64()))
+        {
+            if (next->display->render_page() == RenderResult::FAILED)
+                next->is_skipped = true;
+            if (!next->display->has_pending_updates())
+                next->is_pending = false;
+        }
+
+        _clear_skipped();
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    uint8_t DisplayManager<MAX_DISPLAYS>::get_display_count() const
+    {
+        return _display_count;
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    typename DisplayManager<MAX_DISPLAYS>::ManagedDisplay* DisplayManager<MAX_DISPLAYS>::_pick_next(uint64_t now_us)
+    {
+        ManagedDisplay* next   = nullptr;
+        uint64_t next_deadline = 0;
+
+        // earliest deadline first, priority breaks ties so overdue panels never wait behind a long full-frame flush
+        for (uint8_t i = 0; i < _display_count; i++)
+        {
+            ManagedDisplay& managed = _displays[i];
+
+            if (managed.is_skipped)
+                continue;
+
+            if (!managed.display->has_pending_updates())
+            {
+                managed.is_pending = false;
+                continue;
+            }
+
+            if (!managed.is_pending)
+            {
+                managed.is_pending       = true;
+                managed.pending_since_us = now_us;
+            }
+
+            uint64_t deadline = managed.pending_since_us + managed.latency_budget_us;
+
+            if (next == nullptr || deadline < next_deadline || (deadline == next_deadline && managed.priority > next->priority))
+            {
+                next          = &managed;
+                next_deadline = deadline;
+            }
+        }
+
+        return next;
+    }
+
+    template<uint8_t MAX_DISPLAYS>
+    void DisplayManager<MAX_DISPLAYS>::_clear_skipped()
+    {
+        for (uint8_t i = 0; i < _display_count; i++)
+            _displays[i].is_skipped = false;
+    }
+
+}    // namespace ssd1306_pico
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "framebuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace ssd1306_pico
+{
+    enum class DitherMode : uint8_t
+    {
+        ORDERED,            // 8x8 Bayer matrix, no state between pixels
+        ERROR_DIFFUSION,    // Floyd-Steinberg
+    };
+
+    // Converts 8-bit grayscale to 1bpp one row at a time, so the source never has to be held in full.
+    // rows are accumulated into page-major column bytes and written to the framebuffer every 8 rows
+    template<uint8_t MAX_WIDTH>
+    class Ditherer
+    {
+    public:
+        Ditherer(DitherMode mode = DitherMode::ORDERED);
+        Ditherer(const Ditherer& ditherer)            = delete;
+        Ditherer(Ditherer&& ditherer)                 = delete;
+        Ditherer& operator=(const Ditherer& ditherer) = delete;
+        Ditherer& operator=(Ditherer&& ditherer)      = delete;
+        ~Ditherer()                                   = default;
+
+        void set_mode(DitherMode mode);
+
+        // starts an image at x, y, widths past MAX_WIDTH are cut off
+        void begin(int16_t x, int16_t y, uint8_t width);
+
+        // row holds width grayscale pixels, 0 is off and 255 is on
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void push_row(FrameBuffer<WIDTH, HEIGHT>& framebuffer, const uint8_t* row);
+
+        // writes out the rows of a partially filled strip
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void finish(FrameBuffer<WIDTH, HEIGHT>& framebuffer);
+
+        // dithers a whole row-major grayscale image
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t width, uint8_t height, const uint8_t* pixels);
+
+    private:
+        void _push_ordered(const uint8_t* row, uint8_t bit);
+        void _push_error_diffusion(const uint8_t* row, uint8_t bit);
+
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void _flush(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t rows);
+
+    private:
+        DitherMode _mode;
+
+        int16_t _x     = 0;
+        int16_t _y     = 0;
+        uint8_t _width = 0;
+        uint16_t _row  = 0;
+
+        uint8_t _columns[MAX_WIDTH] = {};
+
+        // error carried into the next row, padded by one on each side so the kernel needs no edge checks
+        int16_t _errors[MAX_WIDTH + 2] = {};
+    };
+
+    // thresholds of the 8x8 Bayer matrix scaled to 2..254, a pixel is on when it reaches its threshold
+    inline constexpr uint8_t BAYER_THRESHOLDS[8][8] = {
+        {  2, 130,  34, 162,  10, 138,  42, 170},
+        {194,  66, 226,  98, 202,  74, 234, 106},
+        { 50, 178,  18, 146,  58, 186,  26, 154},
+        {242, 114, 210,  82, 250, 122, 218,  90},
+        { 14, 142,  46, 174,   6, 134,  38, 166},
+        {206,  78, 238, 110, 198,  70, 230, 102},
+        { 62, 190,  30, 158,  54, 182,  22, 150},
+        {254, 126, 222,  94, 246, 118, 214,  86},
+    };
+
+    template<uint8_t MAX_WIDTH>
+    Ditherer<MAX_WIDTH>::Ditherer(DitherMode mode) : _mode(mode)
+    {
+    }
+
+    template<uint8_t MAX_WIDTH>
+    void Ditherer<MAX_WIDTH>::set_mode(DitherMode mode)
+    {
+        _mode = mode;
+    }
+
+    template<uint8_t MAX_WIDTH>
+    void Ditherer<MAX_WIDTH>::begin(int16_t x, int16_t y, uint8_t width)
+    {
+        _x     = x;
+        _y     = y;
+        _width = std::min<uint8_t>(width, MAX_WIDTH);
+        _row   = 0;
+
+        std::fill(_columns, _columns + MAX_WIDTH, 0);
+        std::fill(_errors, _errors + MAX_WIDTH + 2, 0);
+    }
+
+    template<uint8_t MAX_WIDTH>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void Ditherer<MAX_WIDTH>::push_row(FrameBuffer<WIDTH, HEIGHT>& framebuffer, const uint8_t* row)
+    {
+        uint8_t bit = _row % 8;
+
+        if (_mode == DitherMode::ORDERED)
+            _push_ordered(row, bit);
+        else
+            _push_error_diffusion(row, bit);
+
+        _row++;
+
+        if (bit == 7)
+            _flush(framebuffer, 8);
+    }
+
+    template<uint8_t MAX_WIDTH>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void Ditherer<MAX_WIDTH>::finish(FrameBuffer<WIDTH, HEIGHT>& framebuffer)
+    {
+        if (_row % 8 != 0)
+            _flush(framebuffer, _row % 8);
+    }
+
+    template<uint8_t MAX_WIDTH>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void Ditherer<MAX_WIDTH>::draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t width, uint8_t height, const uint8_t* pixels)
+    {
+        begin(x, y, width);
+
+        for (uint8_t row = 0; row < height; row++)
+            push_row(framebuffer, pixels + row * width);
+
+        finish(framebuffer);
+    }
+
+    template<uint8_t MAX_WIDTH>
+    void Ditherer<MAX_WIDTH>::_push_ordered(const uint8_t* row, uint8_t bit)
+    {
+        constexpr uint32_t HIGH_BITS = 0x80808080;
+
+        const uint8_t* thresholds = BAYER_THRESHOLDS[_row % 8];
+        uint8_t column            = 0;
+
+        // four pixels per word, each byte lane is compared on its own and the lanes stay in memory order,
+        // so the result ORs straight into four column bytes
+        for (; column + 4 <= _width; column += 4)
+        {
+            uint32_t pixels;
+            uint32_t limits;
+            uint32_t bits;
+
+            std::memcpy(&pixels, row + column, 4);
+            std::memcpy(&limits, thresholds + (column & 4), 4);
+            std::memcpy(&bits, _columns + column, 4);
+
+            // the low 7 bits are subtracted with a guard bit so no lane borrows from the next, lanes whose
+            // top bits differ take the pixel's top bit instead
+            uint32_t low_compare = (pixels | HIGH_BITS) - (limits & ~HIGH_BITS);
+            uint32_t differs     = pixels ^ limits;
+            uint32_t is_on       = ((low_compare & ~differs) | (pixels & differs)) & HIGH_BITS;
+
+            bits |= (is_on >> 7) << bit;
+            std::memcpy(_columns + column, &bits, 4);
+        }
+
+        for (; column < _width; column++)
+        {
+            if (row[column] >= thresholds[column % 8])
+                _columns[column] |= 1 << bit;
+        }
+    }
+
+    template<uint8_t MAX_WIDTH>
+    void Ditherer<MAX_WIDTH>::_push_error_diffusion(const uint8_t* row, uint8_t bit)
+    {
+        // _errors[column + 1] holds what this row inherited, it's overwritten with what the next row
+        // inherits once the column is done
+        int16_t carry_right = 0;
+        int16_t below_left  = 0;
+        int16_t below       = 0;
+
+        for (uint8_t column = 0; column < _width; column++)
+        {
+            int16_t value = row[column] + _errors[column + 1] + carry_right;
+            int16_t error;
+
+            if (value >= 128)
+            {
+                _columns[column] |= 1 << bit;
+                error = value - 255;
+            }
+            else
+            {
+                error = value;
+            }
+
+            // 7/16 right, 3/16 below left, 5/16 below, 1/16 below right, the remainder goes right so nothing is lost
+            int16_t error_below_left  = error * 3 / 16;
+            int16_t error_below       = error * 5 / 16;
+            int16_t error_below_right = error / 16;
+
+            carry_right = error - error_below_left - error_below - error_below_right;
+
+            _errors[column] = below_left + error_below_left;
+            below_left      = below + error_below;
+            below           = error_below_right;
+        }
+
+        _errors[_width]     = below_left;
+        _errors[_width + 1] = 0;
+    }
+
+    template<uint8_t MAX_WIDTH>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void Ditherer<MAX_WIDTH>::_flush(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t rows)
+    {
+        framebuffer.blit_strip(_x, _y + _row - rows, _columns, _width, rows);
+        std::fill(_columns, _columns + _width, 0);
+    }
+
+}    // namespace ssd1306_pico
@@ -2,29 +2,84 @@
 
 #include "bitmap.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 
 namespace ssd1306_pico {
+// code points first to last are the glyphs from glyph_index on in the atlas,
+// which is read left to right and top to bottom
+struct GlyphRange {
+  char32_t first;
+  char32_t last;
+  uint16_t glyph_index;
+};
+
+// horizontal adjustment between two glyphs of a proportional font, negative
+// pulls them together
+struct KerningPair {
+  char32_t left;
+  char32_t right;
+  int8_t adjust;
+};
+
+// the columns of a glyph cell that hold set pixels, width is 0 for blank
+// glyphs like the space
+struct GlyphExtent {
+  uint8_t left;
+  uint8_t width;
+};
+
 class Font {
 public:
-  Font(uint8_t glyph_width, uint8_t glyph_height, uint8_t glyph_offset,
-       uint8_t font_map_width, uint8_t _font_map_height, const Bitmap &buffer,
-       bool is_number_only = false);
+  // ASCII fonts starting at ' ', or at '0' when number only, glyph_offset
+  // glyphs into the atlas. extents, when given, holds every atlas glyph's
+  // extent, see GlyphExtents
+  constexpr Font(uint8_t glyph_width, uint8_t glyph_height,
+                 uint8_t glyph_offset, uint8_t font_map_width,
+                 uint8_t font_map_height, const Bitmap &buffer,
+                 bool is_number_only = false,
+                 const GlyphExtent *extents = nullptr);
+
+  // sparse fonts, ranges have to be sorted by code point and kerning pairs by
+  // left then right code point, all of them must outlive the font
+  constexpr Font(uint8_t glyph_width, uint8_t glyph_height,
+                 uint8_t font_map_width, uint8_t font_map_height,
+                 const Bitmap &buffer, const GlyphRange *ranges,
+                 uint8_t range_count,
+                 const KerningPair *kerning_pairs = nullptr,
+                 uint16_t kerning_pair_count = 0,
+                 const GlyphExtent *extents = nullptr);
   Font(const Font &font) = delete;
   Font(Font &&font) = delete;
   Font &operator=(const Font &font) = delete;
   Font &operator=(Font &&font) = delete;
-  ~Font() = default;
+  constexpr ~Font() = default;
+
+  [[nodiscard]] constexpr uint8_t get_font_map_width() const;
+  [[nodiscard]] constexpr uint8_t get_font_map_height() const;
+
+  [[nodiscard]] constexpr bool is_number_only() const;
+  [[nodiscard]] constexpr uint8_t get_glyph_width() const;
+  [[nodiscard]] constexpr uint8_t get_glyph_height() const;
+  [[nodiscard]] constexpr uint8_t get_glyph_offset() const;
 
-  [[nodiscard]] uint8_t get_font_map_width() const;
-  [[nodiscard]] uint8_t get_font_map_height() const;
+  [[nodiscard]] constexpr const Bitmap &get_font_map() const;
 
-  [[nodiscard]] bool is_number_only() const;
-  [[nodiscard]] uint8_t get_glyph_width() const;
-  [[nodiscard]] uint8_t get_glyph_height() const;
-  [[nodiscard]] uint8_t get_glyph_offset() const;
+  // atlas index of the glyph, or -1 when the font doesn't have it
+  [[nodiscard]] constexpr int16_t get_glyph_index(char32_t code_point) const;
 
-  [[nodiscard]] const Bitmap &get_font_map() const;
+  // top left corner of the glyph's cell in the atlas
+  [[nodiscard]] constexpr uint8_t get_glyph_map_x(int16_t glyph_index) const;
+  [[nodiscard]] constexpr uint8_t get_glyph_map_y(int16_t glyph_index) const;
+
+  // proportional text advances by the inked width. looked up in the font's
+  // extents, or scanned from the atlas when it has none
+  [[nodiscard]] constexpr GlyphExtent
+  get_glyph_extent(int16_t glyph_index) const;
+
+  [[nodiscard]] constexpr int8_t get_kerning(char32_t left,
+                                             char32_t right) const;
 
 private:
   uint8_t _glyph_width;
@@ -37,6 +92,169 @@ private:
   Bitmap _font_map;
 
   bool _is_number_only = false;
+
+  // ASCII fonts point this at _ascii_range
+  GlyphRange _ascii_range = {};
+  const GlyphRange *_ranges;
+  uint8_t _range_count;
+
+  const KerningPair *_kerning_pairs = nullptr;
+  uint16_t _kerning_pair_count = 0;
+
+  const GlyphExtent *_extents = nullptr;
+};
+
+// the extent of every glyph in an atlas, scanned at compile time so
+// proportional text doesn't scan the atlas for every glyph it measures or
+// draws. made from the same data as the font it's given to, cells past the end
+// of the data are blank
+template <uint8_t GLYPH_WIDTH, uint8_t GLYPH_HEIGHT, uint8_t FONT_MAP_WIDTH,
+          uint8_t FONT_MAP_HEIGHT>
+struct GlyphExtents {
+  static constexpr uint16_t GLYPH_COUNT =
+      (FONT_MAP_WIDTH / GLYPH_WIDTH) * (FONT_MAP_HEIGHT / GLYPH_HEIGHT);
+
+  template <size_t SIZE>
+  constexpr explicit GlyphExtents(const uint8_t (&font_map)[SIZE]) {
+    // a font without extents of its own scans them
+    const Font font(GLYPH_WIDTH, GLYPH_HEIGHT, 0, FONT_MAP_WIDTH,
+                    FONT_MAP_HEIGHT,
+                    Bitmap(FONT_MAP_WIDTH, FONT_MAP_HEIGHT, font_map));
+
+    for (uint16_t i = 0; i < GLYPH_COUNT; i++) {
+      uint8_t last_page = (font.get_glyph_map_y(i) + GLYPH_HEIGHT - 1) / 8;
+      size_t last_byte = font.get_glyph_map_x(i) + GLYPH_WIDTH - 1 +
+                         last_page * FONT_MAP_WIDTH;
+
+      if (last_byte < SIZE)
+        extents[i] = font.get_glyph_extent(i);
+    }
+  }
+
+  GlyphExtent extents[GLYPH_COUNT] = {};
 };
 
+constexpr Font::Font(uint8_t glyph_width, uint8_t glyph_height,
+                     uint8_t glyph_offset, uint8_t font_map_width,
+                     uint8_t font_map_height, const Bitmap &buffer,
+                     bool is_number_only, const GlyphExtent *extents)
+    : _glyph_width(glyph_width), _glyph_height(glyph_height),
+      _glyph_offset(glyph_offset), _font_map_width(font_map_width),
+      _font_map_height(font_map_height), _font_map(buffer),
+      _is_number_only(is_number_only), _ranges(&_ascii_range),
+      _range_count(1), _extents(extents) {
+  uint16_t glyph_count =
+      (font_map_width / glyph_width) * (font_map_height / glyph_height);
+
+  _ascii_range.first = is_number_only ? '0' : ' ';
+  _ascii_range.last = _ascii_range.first + (glyph_count - glyph_offset) - 1;
+  _ascii_range.glyph_index = glyph_offset;
+}
+
+constexpr Font::Font(uint8_t glyph_width, uint8_t glyph_height,
+                     uint8_t font_map_width, uint8_t font_map_height,
+                     const Bitmap &buffer, const GlyphRange *ranges,
+                     uint8_t range_count, const KerningPair *kerning_pairs,
+                     uint16_t kerning_pair_count,
+                     const GlyphExtent *extents)
+    : _glyph_width(glyph_width), _glyph_height(glyph_height),
+      _glyph_offset(0), _font_map_width(font_map_width),
+      _font_map_height(font_map_height), _font_map(buffer), _ranges(ranges),
+      _range_count(range_count), _kerning_pairs(kerning_pairs),
+      _kerning_pair_count(kerning_pair_count), _extents(extents) {}
+
+constexpr uint8_t Font::get_font_map_width() const { return _font_map_width; }
+
+constexpr uint8_t Font::get_font_map_height() const { return _font_map_height; }
+
+constexpr uint8_t Font::get_glyph_width() const { return _glyph_width; }
+
+constexpr uint8_t Font::get_glyph_height() const { return _glyph_height; }
+
+constexpr uint8_t Font::get_glyph_offset() const { return _glyph_offset; }
+
+constexpr const Bitmap &Font::get_font_map() const { return _font_map; }
+
+constexpr bool Font::is_number_only() const { return _is_number_only; }
+
+constexpr int16_t Font::get_glyph_index(char32_t code_point) const {
+  // binary search for the last range starting at or before the code point
+  const GlyphRange *range = std::upper_bound(
+      _ranges, _ranges + _range_count, code_point,
+      [](char32_t value, const GlyphRange &range) {
+        return value < range.first;
+      });
+
+  if (range == _ranges)
+    return -1;
+
+  range--;
+  if (code_point > range->last)
+    return -1;
+
+  return range->glyph_index + (code_point - range->first);
+}
+
+constexpr uint8_t Font::get_glyph_map_x(int16_t glyph_index) const {
+  uint8_t chars_per_row = _font_map_width / _glyph_width;
+  return (glyph_index % chars_per_row) * _glyph_width;
+}
+
+constexpr uint8_t Font::get_glyph_map_y(int16_t glyph_index) const {
+  uint8_t chars_per_row = _font_map_width / _glyph_width;
+  return glyph_index / chars_per_row * _glyph_height;
+}
+
+constexpr GlyphExtent Font::get_glyph_extent(int16_t glyph_index) const {
+  if (_extents != nullptr)
+    return _extents[glyph_index];
+
+  uint8_t map_x = get_glyph_map_x(glyph_index);
+  uint8_t map_y = get_glyph_map_y(glyph_index);
+
+  uint8_t first_page = map_y / 8;
+  uint8_t last_page = (map_y + _glyph_height - 1) / 8;
+
+  const uint8_t *data = _font_map.get_data();
+
+  uint8_t first = _glyph_width;
+  uint8_t last = 0;
+
+  for (uint8_t column = 0; column < _glyph_width; column++) {
+    for (uint8_t page = first_page; page <= last_page; page++) {
+      // cells don't have to be page aligned, only the glyph's own rows count
+      uint8_t mask = 0xFF;
+      if (page == first_page)
+        mask &= 0xFF << (map_y % 8);
+      if (page == last_page)
+        mask &= 0xFF >> (7 - (map_y + _glyph_height - 1) % 8);
+
+      if (data[map_x + column + page * _font_map_width] & mask) {
+        first = std::min(first, column);
+        last = column;
+        break;
+      }
+    }
+  }
+
+  if (first == _glyph_width)
+    return {0, 0};
+
+  return {first, static_cast<uint8_t>(last - first + 1)};
+}
+
+constexpr int8_t Font::get_kerning(char32_t left, char32_t right) const {
+  const KerningPair *end = _kerning_pairs + _kerning_pair_count;
+  const KerningPair *pair = std::lower_bound(
+      _kerning_pairs, end, KerningPair{left, right, 0},
+      [](const KerningPair &a, const KerningPair &b) {
+        return a.left < b.left || (a.left == b.left && a.right < b.right);
+      });
+
+  if (pair == end || pair->left != left || pair->right != right)
+    return 0;
+
+  return pair->adjust;
+}
+
 } // namespace ssd1306_pico
\ No newline at end of file
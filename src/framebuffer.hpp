@@ -2,36 +2,163 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <utility>
 
+#include "bit_spread.hpp"
 #include "bitmap.hpp"
+#include "compressed_bitmap.hpp"
+#include "trace.hpp"
 
 namespace ssd1306_pico {
+struct Point {
+  int16_t x;
+  int16_t y;
+};
+
+inline constexpr uint8_t MAX_POLYGON_VERTICES = 16;
+
 template <uint8_t WIDTH, uint8_t HEIGHT> class FrameBuffer {
 public:
-  FrameBuffer(bool filled = false);
-  FrameBuffer(const uint8_t *data);
+  constexpr FrameBuffer(bool filled = false);
+  constexpr FrameBuffer(const uint8_t *data);
   FrameBuffer(const FrameBuffer &framebuffer) = delete;
   FrameBuffer(FrameBuffer &&framebuffer) = delete;
   FrameBuffer &operator=(const FrameBuffer &framebuffer) = delete;
   FrameBuffer &operator=(FrameBuffer &&framebuffer) = delete;
-  ~FrameBuffer() = default;
+  constexpr ~FrameBuffer() = default;
+
+  [[nodiscard]] constexpr const uint8_t *get_data() const;
+
+  constexpr void fill();
+  constexpr void clear();
+
+  // each push narrows the clip rect or moves the origin until the matching pop,
+  // rects are given in the coordinates of the current origin. pushes nested
+  // deeper than MAX_CLIP_DEPTH clip everything away until they are popped
+  constexpr void push_clip(int16_t x, int16_t y, uint8_t width,
+                           uint8_t height);
+  constexpr void push_translation(int16_t x, int16_t y);
+  constexpr void push_viewport(int16_t x, int16_t y, uint8_t width,
+                               uint8_t height);
+  constexpr void pop_clip();
+
+  // narrows the rect [start, end) to the part the clip lets through, still in
+  // the coordinates of the current origin. false when none of it is visible
+  [[nodiscard]] constexpr bool get_visible_rect(int16_t &start_x,
+                                                int16_t &start_y,
+                                                int16_t &end_x,
+                                                int16_t &end_y) const;
+
+  constexpr void draw_pixel(int16_t x, int16_t y);
+  constexpr void erase_pixel(int16_t x, int16_t y);
+
+  constexpr void fill_rect(int16_t x, int16_t y, uint8_t width,
+                           uint8_t height);
+  constexpr void erase_rect(int16_t x, int16_t y, uint8_t width,
+                            uint8_t height);
+  constexpr void draw_line(int16_t start_x, int16_t start_y, int16_t end_x,
+                           int16_t end_y);
 
-  [[nodiscard]] const uint8_t *get_data() const;
+  // vertices sit on pixel centers and the right and bottom edges are
+  // exclusive, like fill_rect. polygons are filled with the even-odd rule,
+  // ones with more than MAX_POLYGON_VERTICES vertices or further than 16383
+  // pixels from the screen are not drawn
+  constexpr void fill_triangle(Point a, Point b, Point c);
+  constexpr void fill_polygon(const Point *points, uint8_t count);
 
-  void fill();
-  void clear();
-  void draw_pixel(uint8_t x, uint8_t y);
-  void erase_pixel(uint8_t x, uint8_t y);
+  constexpr void draw_bitmap(int16_t x, int16_t y, uint8_t map_x,
+                             uint8_t map_y, uint8_t map_width,
+                             uint8_t map_height, const Bitmap &bitmap,
+                             bool transparent = false);
 
-  void draw_bitmap(uint8_t x, uint8_t y, uint8_t map_x, uint8_t map_y,
-                   uint8_t map_width, uint8_t map_height, const Bitmap &bitmap);
+  // every source pixel becomes a scale x scale block, scale is 1 to
+  // MAX_BITMAP_SCALE
+  constexpr void draw_scaled_bitmap(int16_t x, int16_t y, uint8_t map_x,
+                                    uint8_t map_y, uint8_t map_width,
+                                    uint8_t map_height, const Bitmap &bitmap,
+                                    uint8_t scale, bool transparent = false);
+
+  constexpr void draw_compressed_bitmap(int16_t x, int16_t y, uint8_t map_x,
+                                        uint8_t map_y, uint8_t map_width,
+                                        uint8_t map_height,
+                                        const CompressedBitmap &bitmap,
+                                        bool transparent = false);
+
+  // writes width page-major column bytes with bit 0 on row y, only the low
+  // height bits of each are drawn
+  constexpr void blit_strip(int16_t x, int16_t y, const uint8_t *columns,
+                            uint8_t width, uint8_t height = 8);
+
+  // like blit_strip, but the bits are XORed into the buffer. only the columns
+  // whose pixels change are marked dirty
+  constexpr void xor_strip(int16_t x, int16_t y, const uint8_t *columns,
+                           uint8_t width, uint8_t height = 8);
+
+  constexpr void copy_rect(const FrameBuffer &source, int16_t x, int16_t y,
+                           uint8_t width, uint8_t height);
+
+  // moves the pixels of a rect left by columns and clears the columns that
+  // open up on its right, only the rect is marked dirty
+  constexpr void scroll_region_left(int16_t x, int16_t y, uint8_t width,
+                                    uint8_t height, uint8_t columns = 1);
+
+  constexpr void mark_dirty(uint8_t x, uint8_t y, uint8_t width,
+                            uint8_t height);
+  constexpr void mark_all_dirty();
+  constexpr void clear_dirty();
+  constexpr void clear_dirty(uint8_t page);
+
+  [[nodiscard]] constexpr bool is_dirty() const;
+  [[nodiscard]] constexpr bool is_dirty(uint8_t page) const;
+  [[nodiscard]] constexpr uint8_t get_dirty_start(uint8_t page) const;
+  [[nodiscard]] constexpr uint8_t get_dirty_end(uint8_t page) const;
 
 private:
-  uint8_t _data[WIDTH * (HEIGHT / 8)];
+  struct ClipState {
+    int16_t offset_x;
+    int16_t offset_y;
+
+    // clip rect in screen coordinates, [start, end)
+    uint8_t start_x;
+    uint8_t start_y;
+    uint8_t end_x;
+    uint8_t end_y;
+  };
+
+  [[nodiscard]] constexpr bool _clip_rect(int16_t &start_x, int16_t &start_y,
+                                          int16_t &end_x, int16_t &end_y) const;
+
+  [[nodiscard]] constexpr ClipState _get_clip_state(int16_t x, int16_t y,
+                                                    uint8_t width,
+                                                    uint8_t height) const;
+  constexpr void _push_clip_state(const ClipState &state);
+  constexpr void _fill_rect_masked(uint8_t start_x, uint8_t start_y,
+                                   uint8_t end_x, uint8_t end_y, bool filled);
+  constexpr void _mark_dirty_column(uint8_t x, uint8_t page);
+  constexpr void _fill_span(uint8_t start_x, uint8_t end_x, uint8_t y);
+  constexpr void _blit_byte(int16_t x, int16_t y, uint8_t bits, uint8_t mask,
+                            bool transparent);
+  constexpr void _xor_byte(uint8_t x, int16_t y, uint8_t bits);
+
+private:
+  static constexpr uint8_t PAGES = HEIGHT / 8;
+  static constexpr uint8_t MAX_CLIP_DEPTH = 8;
+
+  // the entry past MAX_CLIP_DEPTH stays empty, it's the top while pushes
+  // overflow so nothing escapes a clip that couldn't be stored
+  ClipState _clip_stack[MAX_CLIP_DEPTH + 2] = {{0, 0, 0, 0, WIDTH, HEIGHT}};
+  uint8_t _clip_depth = 0;
+  uint8_t _clip_overflow = 0;
+
+  uint8_t _data[WIDTH * PAGES] = {};
+
+  // dirty column span [start, end) per page, empty when start >= end
+  uint8_t _dirty_start[PAGES] = {};
+  uint8_t _dirty_end[PAGES] = {};
 };
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-FrameBuffer<WIDTH, HEIGHT>::FrameBuffer(bool filled) {
+constexpr FrameBuffer<WIDTH, HEIGHT>::FrameBuffer(bool filled) {
   if (filled)
     fill();
   else
@@ -39,27 +166,116 @@ FrameBuffer<WIDTH, HEIGHT>::FrameBuffer(bool filled) {
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-FrameBuffer<WIDTH, HEIGHT>::FrameBuffer(const uint8_t *data) {
-  std::copy(data, data + (WIDTH * (HEIGHT / 8)), _data);
+constexpr FrameBuffer<WIDTH, HEIGHT>::FrameBuffer(const uint8_t *data) {
+  std::copy(data, data + (WIDTH * PAGES), _data);
+  mark_all_dirty();
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-const uint8_t *FrameBuffer<WIDTH, HEIGHT>::get_data() const {
+constexpr const uint8_t *FrameBuffer<WIDTH, HEIGHT>::get_data() const {
   return _data;
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-void FrameBuffer<WIDTH, HEIGHT>::fill() {
-  std::fill(_data, _data + (WIDTH * (HEIGHT / 8)), 0xFF);
+constexpr void FrameBuffer<WIDTH, HEIGHT>::fill() {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::fill");
+  std::fill(_data, _data + (WIDTH * PAGES), 0xFF);
+  mark_all_dirty();
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::clear() {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::clear");
+  std::fill(_data, _data + (WIDTH * PAGES), 0x00);
+  mark_all_dirty();
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-void FrameBuffer<WIDTH, HEIGHT>::clear() {
-  std::fill(_data, _data + (WIDTH * (HEIGHT / 8)), 0x00);
+constexpr void FrameBuffer<WIDTH, HEIGHT>::push_clip(int16_t x, int16_t y,
+                                                     uint8_t width,
+                                                     uint8_t height) {
+  _push_clip_state(_get_clip_state(x, y, width, height));
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::push_translation(int16_t x,
+                                                            int16_t y) {
+  ClipState state = _clip_stack[_clip_depth];
+
+  state.offset_x += x;
+  state.offset_y += y;
+  _push_clip_state(state);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::push_viewport(int16_t x, int16_t y,
+                                                         uint8_t width,
+                                                         uint8_t height) {
+  ClipState state = _get_clip_state(x, y, width, height);
+
+  state.offset_x += x;
+  state.offset_y += y;
+  _push_clip_state(state);
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-void FrameBuffer<WIDTH, HEIGHT>::draw_pixel(uint8_t x, uint8_t y) {
+constexpr void FrameBuffer<WIDTH, HEIGHT>::pop_clip() {
+  if (_clip_overflow > 0 && --_clip_overflow == 0)
+    _clip_depth = MAX_CLIP_DEPTH;
+  else if (_clip_overflow == 0 && _clip_depth > 0)
+    _clip_depth--;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr bool FrameBuffer<WIDTH, HEIGHT>::get_visible_rect(
+    int16_t &start_x, int16_t &start_y, int16_t &end_x, int16_t &end_y) const {
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return false;
+
+  start_x -= clip.offset_x;
+  start_y -= clip.offset_y;
+  end_x -= clip.offset_x;
+  end_y -= clip.offset_y;
+  return true;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr typename FrameBuffer<WIDTH, HEIGHT>::ClipState
+FrameBuffer<WIDTH, HEIGHT>::_get_clip_state(int16_t x, int16_t y,
+                                            uint8_t width,
+                                            uint8_t height) const {
+  ClipState state = _clip_stack[_clip_depth];
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + height;
+
+  // an empty clip is still pushed so the matching pop stays balanced
+  if (!_clip_rect(start_x, start_y, end_x, end_y)) {
+    start_x = end_x = state.start_x;
+    start_y = end_y = state.start_y;
+  }
+
+  state.start_x = start_x;
+  state.start_y = start_y;
+  state.end_x = end_x;
+  state.end_y = end_y;
+  return state;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::draw_pixel(int16_t x, int16_t y) {
+  const ClipState &clip = _clip_stack[_clip_depth];
+  x += clip.offset_x;
+  y += clip.offset_y;
+
+  if (x < clip.start_x || x >= clip.end_x || y < clip.start_y ||
+      y >= clip.end_y)
+    return;
+
   uint8_t segment = x;
   uint8_t page = y / 8;
 
@@ -67,10 +283,19 @@ void FrameBuffer<WIDTH, HEIGHT>::draw_pixel(uint8_t x, uint8_t y) {
   uint16_t cellpos = segment + page * WIDTH;
 
   _data[cellpos] |= mask;
+  _mark_dirty_column(segment, page);
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-void FrameBuffer<WIDTH, HEIGHT>::erase_pixel(uint8_t x, uint8_t y) {
+constexpr void FrameBuffer<WIDTH, HEIGHT>::erase_pixel(int16_t x, int16_t y) {
+  const ClipState &clip = _clip_stack[_clip_depth];
+  x += clip.offset_x;
+  y += clip.offset_y;
+
+  if (x < clip.start_x || x >= clip.end_x || y < clip.start_y ||
+      y >= clip.end_y)
+    return;
+
   uint8_t segment = x;
   uint8_t page = y / 8;
 
@@ -78,32 +303,729 @@ void FrameBuffer<WIDTH, HEIGHT>::erase_pixel(uint8_t x, uint8_t y) {
   uint16_t cellpos = segment + page * WIDTH;
 
   _data[cellpos] &= mask;
+  _mark_dirty_column(segment, page);
 }
 
 template <uint8_t WIDTH, uint8_t HEIGHT>
-void FrameBuffer<WIDTH, HEIGHT>::draw_bitmap(uint8_t x, uint8_t y,
-                                             uint8_t map_x, uint8_t map_y,
-                                             uint8_t map_width,
-                                             uint8_t map_height,
-                                             const Bitmap &bitmap) {
-  uint8_t screen_x = x;
-  uint8_t screen_y = y;
-  for (uint8_t cur_x = map_x;
-       cur_x < bitmap.get_width() && cur_x < (map_x + map_width); cur_x++) {
-    for (uint8_t cur_y = map_y;
-         cur_y < bitmap.get_height() && cur_y < (map_y + map_height); cur_y++) {
-      uint8_t segment = cur_x;
-      uint8_t page = cur_y / 8;
-      uint8_t mask = 1 << (cur_y % 8);
-      uint16_t cellpos = segment + page * bitmap.get_width();
-
-      if (bitmap.get_data()[cellpos] & mask)
-        draw_pixel(screen_x, screen_y++);
-      else
-        erase_pixel(screen_x, screen_y++);
+constexpr void FrameBuffer<WIDTH, HEIGHT>::fill_rect(int16_t x, int16_t y,
+                                                     uint8_t width,
+                                                     uint8_t height) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::fill_rect");
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + height;
+
+  if (_clip_rect(start_x, start_y, end_x, end_y))
+    _fill_rect_masked(start_x, start_y, end_x, end_y, true);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::erase_rect(int16_t x, int16_t y,
+                                                      uint8_t width,
+                                                      uint8_t height) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::erase_rect");
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + height;
+
+  if (_clip_rect(start_x, start_y, end_x, end_y))
+    _fill_rect_masked(start_x, start_y, end_x, end_y, false);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::draw_line(int16_t start_x,
+                                                     int16_t start_y,
+                                                     int16_t end_x,
+                                                     int16_t end_y) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::draw_line");
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  int16_t delta_x = (end_x > start_x) ? end_x - start_x : start_x - end_x;
+  int16_t delta_y = (end_y > start_y) ? end_y - start_y : start_y - end_y;
+
+  int8_t step_x = (start_x < end_x) ? 1 : -1;
+  int8_t step_y = (start_y < end_y) ? 1 : -1;
+
+  int16_t err = ((delta_x > delta_y) ? delta_x : -delta_y) / 2;
+  int16_t err2;
+
+  // the bounding box is checked once, only lines crossing the clip edge
+  // pay for a per pixel test
+  int16_t box_start_x = std::min(start_x, end_x) + clip.offset_x;
+  int16_t box_start_y = std::min(start_y, end_y) + clip.offset_y;
+  int16_t box_end_x = std::max(start_x, end_x) + clip.offset_x + 1;
+  int16_t box_end_y = std::max(start_y, end_y) + clip.offset_y + 1;
+
+  bool is_inside = box_start_x >= clip.start_x && box_end_x <= clip.end_x &&
+                   box_start_y >= clip.start_y && box_end_y <= clip.end_y;
+
+  if (box_start_x >= clip.end_x || box_end_x <= clip.start_x ||
+      box_start_y >= clip.end_y || box_end_y <= clip.start_y)
+    return;
+
+  if (is_inside) {
+    mark_dirty(box_start_x, box_start_y, box_end_x - box_start_x,
+               box_end_y - box_start_y);
+  }
+
+  while (start_x != end_x || start_y != end_y) {
+    if (is_inside) {
+      uint8_t screen_x = start_x + clip.offset_x;
+      uint8_t screen_y = start_y + clip.offset_y;
+      _data[screen_x + (screen_y / 8) * WIDTH] |= 1 << (screen_y % 8);
+    } else {
+      draw_pixel(start_x, start_y);
+    }
+
+    err2 = err;
+
+    if (err2 > -delta_x) {
+      err -= delta_y;
+      start_x += step_x;
+    }
+    if (err2 < delta_y) {
+      err += delta_x;
+      start_y += step_y;
+    }
+  }
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::fill_triangle(Point a, Point b,
+                                                         Point c) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::fill_triangle");
+  const Point points[3] = {a, b, c};
+  fill_polygon(points, 3);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::fill_polygon(const Point *points,
+                                                        uint8_t count) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::fill_polygon");
+  // x positions are 16.16 fixed point, stepped by a per edge slope on every
+  // scanline
+  struct Edge {
+    int32_t x;
+    int32_t slope;
+    int16_t start_y;
+    int16_t end_y;
+  };
+
+  constexpr int32_t MAX_COORDINATE = 0x3FFF;
+
+  if (count < 3 || count > MAX_POLYGON_VERTICES)
+    return;
+
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  for (uint8_t i = 0; i < count; i++) {
+    int32_t x = points[i].x + clip.offset_x;
+    int32_t y = points[i].y + clip.offset_y;
+
+    if (x > MAX_COORDINATE || -x > MAX_COORDINATE || y > MAX_COORDINATE ||
+        -y > MAX_COORDINATE)
+      return;
+  }
+
+  Edge edges[MAX_POLYGON_VERTICES];
+  uint8_t edge_count = 0;
+  int16_t min_y = clip.end_y;
+  int16_t max_y = clip.start_y;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const Point &from = points[i];
+    const Point &to = points[(i + 1) % count];
+
+    int32_t x0 = from.x + clip.offset_x;
+    int32_t y0 = from.y + clip.offset_y;
+    int32_t x1 = to.x + clip.offset_x;
+    int32_t y1 = to.y + clip.offset_y;
+
+    if (y0 > y1) {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+    }
+
+    // edges are clipped to the visible scanlines, horizontal ones never
+    // cross any
+    int16_t start_y = std::max<int32_t>(y0, clip.start_y);
+    int16_t end_y = std::min<int32_t>(y1, clip.end_y);
+    if (start_y >= end_y)
+      continue;
+
+    // the slope is rounded down so the stepped x never lands right of the
+    // exact one
+    int32_t delta_y = y1 - y0;
+    int32_t delta_x = (x1 - x0) * 65536;
+    int32_t slope = delta_x / delta_y;
+    if (delta_x % delta_y < 0)
+      slope--;
+
+    edges[edge_count++] = {x0 * 65536 + (start_y - y0) * slope, slope,
+                           start_y, end_y};
+
+    min_y = std::min(min_y, start_y);
+    max_y = std::max(max_y, end_y);
+  }
+
+  int16_t min_x = clip.end_x;
+  int16_t max_x = clip.start_x;
+
+  for (int16_t y = min_y; y < max_y; y++) {
+    int32_t crossings[MAX_POLYGON_VERTICES];
+    uint8_t crossing_count = 0;
+
+    for (uint8_t i = 0; i < edge_count; i++) {
+      Edge &edge = edges[i];
+      if (y < edge.start_y || y >= edge.end_y)
+        continue;
+
+      // insertion sort, there are only a handful of crossings per scanline
+      uint8_t pos = crossing_count++;
+      for (; pos > 0 && crossings[pos - 1] > edge.x; pos--)
+        crossings[pos] = crossings[pos - 1];
+      crossings[pos] = edge.x;
+
+      edge.x += edge.slope;
+    }
+
+    for (uint8_t i = 0; i + 1 < crossing_count; i += 2) {
+      // columns whose center lies in [left, right)
+      int16_t start_x = std::max<int32_t>((crossings[i] + 0xFFFF) >> 16,
+                                          clip.start_x);
+      int16_t end_x = std::min<int32_t>((crossings[i + 1] + 0xFFFF) >> 16,
+                                        clip.end_x);
+
+      if (start_x >= end_x)
+        continue;
+
+      _fill_span(start_x, end_x, y);
+      min_x = std::min(min_x, start_x);
+      max_x = std::max(max_x, end_x);
     }
-    screen_x++;
-    screen_y = y;
+  }
+
+  // the edges' vertical extent bounds the spans, so it's close enough for
+  // the dirty rect
+  if (min_x < max_x)
+    mark_dirty(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::draw_bitmap(int16_t x, int16_t y,
+                                                       uint8_t map_x,
+                                                       uint8_t map_y,
+                                                       uint8_t map_width,
+                                                       uint8_t map_height,
+                                                       const Bitmap &bitmap,
+                                                       bool transparent) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::draw_bitmap");
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  uint8_t map_end_x = std::min<uint16_t>(map_x + map_width, bitmap.get_width());
+  uint8_t map_end_y =
+      std::min<uint16_t>(map_y + map_height, bitmap.get_height());
+
+  if (map_x >= map_end_x || map_y >= map_end_y)
+    return;
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + (map_end_x - map_x);
+  int16_t end_y = y + (map_end_y - map_y);
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  // narrow the source rect to what survived the clip
+  map_x += start_x - (x + clip.offset_x);
+  map_y += start_y - (y + clip.offset_y);
+  map_end_x = map_x + (end_x - start_x);
+  map_end_y = map_y + (end_y - start_y);
+
+  uint8_t first_page = map_y / 8;
+  uint8_t last_page = (map_end_y - 1) / 8;
+  const uint8_t *data = bitmap.get_data();
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (map_y % 8);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (map_end_y - 1) % 8);
+
+    int16_t screen_y = start_y + page * 8 - map_y;
+    const uint8_t *row = data + page * bitmap.get_width();
+
+    for (uint8_t cur_x = map_x; cur_x < map_end_x; cur_x++)
+      _blit_byte(start_x + cur_x - map_x, screen_y, row[cur_x], mask,
+                 transparent);
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::draw_scaled_bitmap(
+    int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width,
+    uint8_t map_height, const Bitmap &bitmap, uint8_t scale, bool transparent) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::draw_scaled_bitmap");
+  if (scale <= 1) {
+    draw_bitmap(x, y, map_x, map_y, map_width, map_height, bitmap,
+                transparent);
+    return;
+  }
+
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  scale = std::min(scale, MAX_BITMAP_SCALE);
+
+  uint8_t map_end_x = std::min<uint16_t>(map_x + map_width, bitmap.get_width());
+  uint8_t map_end_y =
+      std::min<uint16_t>(map_y + map_height, bitmap.get_height());
+
+  if (map_x >= map_end_x || map_y >= map_end_y)
+    return;
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + (map_end_x - map_x) * scale;
+  int16_t end_y = y + (map_end_y - map_y) * scale;
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  int16_t screen_x = x + clip.offset_x;
+  int16_t screen_y = y + clip.offset_y;
+
+  const uint8_t *data = bitmap.get_data();
+  uint8_t map_w = bitmap.get_width();
+  uint8_t last_page = (bitmap.get_height() - 1) / 8;
+
+  // 8 source rows at a time, spread into 8 * scale screen rows
+  for (uint8_t row = map_y; row < map_end_y; row += 8) {
+    int16_t block_y = screen_y + (row - map_y) * scale;
+    if (block_y >= end_y)
+      break;
+    if (block_y + 8 * scale <= start_y)
+      continue;
+
+    uint8_t page = row / 8;
+    uint8_t shift = row % 8;
+
+    // source rows past map_end_y are masked off, and so are screen rows
+    // outside the clip rect
+    uint8_t rows = std::min<uint8_t>(8, map_end_y - row);
+    uint32_t mask = spread_bits(0xFF >> (8 - rows), scale);
+    if (block_y < start_y)
+      mask &= ~0u << (start_y - block_y);
+    if (end_y - block_y < 32)
+      mask &= ~(~0u << (end_y - block_y));
+
+    for (uint8_t cur_x = map_x; cur_x < map_end_x; cur_x++) {
+      int16_t block_x = screen_x + (cur_x - map_x) * scale;
+      if (block_x >= end_x)
+        break;
+      if (block_x + scale <= start_x)
+        continue;
+
+      // the 8 rows can straddle two source pages
+      uint8_t bits = data[page * map_w + cur_x] >> shift;
+      if (shift != 0 && page < last_page)
+        bits |= data[(page + 1) * map_w + cur_x] << (8 - shift);
+
+      uint32_t spread = spread_bits(bits, scale);
+
+      for (int16_t col = std::max(block_x, start_x);
+           col < std::min<int16_t>(block_x + scale, end_x); col++) {
+        for (uint8_t byte = 0; byte < scale; byte++) {
+          uint8_t byte_mask = mask >> (byte * 8);
+          if (byte_mask != 0)
+            _blit_byte(col, block_y + byte * 8, spread >> (byte * 8),
+                       byte_mask, transparent);
+        }
+      }
+    }
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::draw_compressed_bitmap(
+    int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width,
+    uint8_t map_height, const CompressedBitmap &bitmap, bool transparent) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::draw_compressed_bitmap");
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  uint8_t map_end_x = std::min<uint16_t>(map_x + map_width, bitmap.get_width());
+  uint8_t map_end_y =
+      std::min<uint16_t>(map_y + map_height, bitmap.get_height());
+
+  if (map_x >= map_end_x || map_y >= map_end_y)
+    return;
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + (map_end_x - map_x);
+  int16_t end_y = y + (map_end_y - map_y);
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  map_x += start_x - (x + clip.offset_x);
+  map_y += start_y - (y + clip.offset_y);
+  map_end_x = map_x + (end_x - start_x);
+  map_end_y = map_y + (end_y - start_y);
+
+  uint8_t first_page = map_y / 8;
+  uint8_t last_page = (map_end_y - 1) / 8;
+
+  // the stream is decoded in order, bytes outside the sub-rect are skipped
+  RleReader reader(bitmap.get_data());
+  reader.skip(first_page * bitmap.get_width());
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (map_y % 8);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (map_end_y - 1) % 8);
+
+    int16_t screen_y = start_y + page * 8 - map_y;
+
+    reader.skip(map_x);
+    for (uint8_t cur_x = map_x; cur_x < map_end_x; cur_x++)
+      _blit_byte(start_x + cur_x - map_x, screen_y, reader.next(), mask,
+                 transparent);
+    reader.skip(bitmap.get_width() - map_end_x);
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::blit_strip(int16_t x, int16_t y,
+                                                      const uint8_t *columns,
+                                                      uint8_t width,
+                                                      uint8_t height) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::blit_strip");
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + std::min<uint8_t>(height, 8);
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  // the strip is clipped once, rows outside the clip rect are masked off
+  int16_t top = y + clip.offset_y;
+  uint8_t mask = (0xFF << (start_y - top)) & (0xFF >> (8 - (end_y - top)));
+  const uint8_t *source = columns + (start_x - x - clip.offset_x);
+
+  for (int16_t col = start_x; col < end_x; col++)
+    _blit_byte(col, top, *source++, mask, false);
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::xor_strip(int16_t x, int16_t y,
+                                                     const uint8_t *columns,
+                                                     uint8_t width,
+                                                     uint8_t height) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::xor_strip");
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + std::min<uint8_t>(height, 8);
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  int16_t top = y + clip.offset_y;
+  uint8_t mask = (0xFF << (start_y - top)) & (0xFF >> (8 - (end_y - top)));
+  const uint8_t *source = columns + (start_x - x - clip.offset_x);
+
+  for (int16_t col = start_x; col < end_x; col++)
+    _xor_byte(col, top, *source++ & mask);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::copy_rect(const FrameBuffer &source,
+                                                     int16_t x, int16_t y,
+                                                     uint8_t width,
+                                                     uint8_t height) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::copy_rect");
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + height;
+
+  if (!_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  uint8_t first_page = start_y / 8;
+  uint8_t last_page = (end_y - 1) / 8;
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (start_y % 8);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (end_y - 1) % 8);
+
+    uint8_t *dst = _data + page * WIDTH;
+    const uint8_t *src = source._data + page * WIDTH;
+
+    if (mask == 0xFF) {
+      std::copy(src + start_x, src + end_x, dst + start_x);
+      continue;
+    }
+
+    for (int16_t col = start_x; col < end_x; col++)
+      dst[col] = (dst[col] & ~mask) | (src[col] & mask);
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::scroll_region_left(
+    int16_t x, int16_t y, uint8_t width, uint8_t height, uint8_t columns) {
+  SSD1306_PICO_TRACE_SCOPE("FrameBuffer::scroll_region_left");
+  int16_t start_x = x;
+  int16_t start_y = y;
+  int16_t end_x = x + width;
+  int16_t end_y = y + height;
+
+  if (columns == 0 || !_clip_rect(start_x, start_y, end_x, end_y))
+    return;
+
+  int16_t kept_end = std::max<int16_t>(end_x - columns, start_x);
+
+  uint8_t first_page = start_y / 8;
+  uint8_t last_page = (end_y - 1) / 8;
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (start_y % 8);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (end_y - 1) % 8);
+
+    uint8_t *row = _data + page * WIDTH;
+
+    // whole pages are a single memmove, the copy runs forwards so the
+    // overlap is safe
+    if (mask == 0xFF) {
+      if (kept_end > start_x)
+        std::copy(row + start_x + columns, row + end_x, row + start_x);
+      std::fill(row + kept_end, row + end_x, 0x00);
+      continue;
+    }
+
+    for (int16_t col = start_x; col < kept_end; col++)
+      row[col] = (row[col] & ~mask) | (row[col + columns] & mask);
+    for (int16_t col = kept_end; col < end_x; col++)
+      row[col] &= ~mask;
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::mark_dirty(uint8_t x, uint8_t y,
+                                                      uint8_t width,
+                                                      uint8_t height) {
+  if (width == 0 || height == 0 || x >= WIDTH || y >= HEIGHT)
+    return;
+
+  uint8_t end_x = std::min<uint16_t>(x + width, WIDTH);
+  uint8_t first_page = y / 8;
+  uint8_t last_page = std::min<uint16_t>(y + height - 1, HEIGHT - 1) / 8;
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    _dirty_start[page] = std::min(_dirty_start[page], x);
+    _dirty_end[page] = std::max(_dirty_end[page], end_x);
+  }
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::mark_all_dirty() {
+  std::fill(_dirty_start, _dirty_start + PAGES, 0);
+  std::fill(_dirty_end, _dirty_end + PAGES, WIDTH);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::clear_dirty() {
+  std::fill(_dirty_start, _dirty_start + PAGES, WIDTH);
+  std::fill(_dirty_end, _dirty_end + PAGES, 0);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::clear_dirty(uint8_t page) {
+  _dirty_start[page] = WIDTH;
+  _dirty_end[page] = 0;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr bool FrameBuffer<WIDTH, HEIGHT>::is_dirty() const {
+  for (uint8_t page = 0; page < PAGES; page++) {
+    if (is_dirty(page))
+      return true;
+  }
+
+  return false;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr bool FrameBuffer<WIDTH, HEIGHT>::is_dirty(uint8_t page) const {
+  return _dirty_start[page] < _dirty_end[page];
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr uint8_t FrameBuffer<WIDTH, HEIGHT>::get_dirty_start(
+    uint8_t page) const {
+  return _dirty_start[page];
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr uint8_t FrameBuffer<WIDTH, HEIGHT>::get_dirty_end(
+    uint8_t page) const {
+  return _dirty_end[page];
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr bool FrameBuffer<WIDTH, HEIGHT>::_clip_rect(int16_t &start_x,
+                                                      int16_t &start_y,
+                                                      int16_t &end_x,
+                                                      int16_t &end_y) const {
+  const ClipState &clip = _clip_stack[_clip_depth];
+
+  start_x = std::max<int16_t>(start_x + clip.offset_x, clip.start_x);
+  start_y = std::max<int16_t>(start_y + clip.offset_y, clip.start_y);
+  end_x = std::min<int16_t>(end_x + clip.offset_x, clip.end_x);
+  end_y = std::min<int16_t>(end_y + clip.offset_y, clip.end_y);
+
+  return start_x < end_x && start_y < end_y;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_push_clip_state(
+    const ClipState &state) {
+  if (_clip_depth >= MAX_CLIP_DEPTH) {
+    _clip_overflow++;
+    _clip_depth = MAX_CLIP_DEPTH + 1;
+    return;
+  }
+
+  _clip_stack[++_clip_depth] = state;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_fill_rect_masked(
+    uint8_t start_x, uint8_t start_y, uint8_t end_x, uint8_t end_y,
+    bool filled) {
+  uint8_t first_page = start_y / 8;
+  uint8_t last_page = (end_y - 1) / 8;
+
+  for (uint8_t page = first_page; page <= last_page; page++) {
+    uint8_t mask = 0xFF;
+    if (page == first_page)
+      mask &= 0xFF << (start_y % 8);
+    if (page == last_page)
+      mask &= 0xFF >> (7 - (end_y - 1) % 8);
+
+    uint8_t *row = _data + page * WIDTH;
+
+    if (filled) {
+      for (uint8_t col = start_x; col < end_x; col++)
+        row[col] |= mask;
+    } else {
+      for (uint8_t col = start_x; col < end_x; col++)
+        row[col] &= ~mask;
+    }
+  }
+
+  mark_dirty(start_x, start_y, end_x - start_x, end_y - start_y);
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_mark_dirty_column(
+    uint8_t x, uint8_t page) {
+  if (x < _dirty_start[page])
+    _dirty_start[page] = x;
+  if (x >= _dirty_end[page])
+    _dirty_end[page] = x + 1;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_fill_span(uint8_t start_x,
+                                                      uint8_t end_x,
+                                                      uint8_t y) {
+  uint8_t *row = _data + (y / 8) * WIDTH;
+  uint8_t mask = 1 << (y % 8);
+
+  for (uint8_t col = start_x; col < end_x; col++)
+    row[col] |= mask;
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_xor_byte(uint8_t x, int16_t y,
+                                                     uint8_t bits) {
+  // bit 0 lands on row y, the bits are already clipped to the buffer
+  uint16_t wide_bits = y < 0 ? bits >> -y : bits << (y % 8);
+  y = std::max<int16_t>(y, 0);
+
+  for (uint8_t page = y / 8; page < PAGES && wide_bits != 0; page++) {
+    if ((wide_bits & 0xFF) != 0) {
+      _data[x + page * WIDTH] ^= wide_bits & 0xFF;
+      _mark_dirty_column(x, page);
+    }
+
+    wide_bits >>= 8;
+  }
+}
+
+template <uint8_t WIDTH, uint8_t HEIGHT>
+constexpr void FrameBuffer<WIDTH, HEIGHT>::_blit_byte(int16_t x, int16_t y,
+                                                      uint8_t bits,
+                                                      uint8_t mask,
+                                                      bool transparent) {
+  if (x < 0 || x >= WIDTH || y >= HEIGHT || y <= -8)
+    return;
+
+  if (transparent)
+    mask &= bits;
+
+  // bit 0 lands on row y, which can straddle two pages
+  uint16_t wide_bits = bits;
+  uint16_t wide_mask = mask;
+  if (y < 0) {
+    wide_bits >>= -y;
+    wide_mask >>= -y;
+    y = 0;
+  } else {
+    wide_bits <<= y % 8;
+    wide_mask <<= y % 8;
+  }
+
+  for (uint8_t page = y / 8; page < PAGES && wide_mask != 0; page++) {
+    uint8_t page_mask = wide_mask & 0xFF;
+    uint8_t &cell = _data[x + page * WIDTH];
+
+    if (page_mask != 0)
+      cell = (cell & ~page_mask) | (wide_bits & page_mask);
+
+    wide_bits >>= 8;
+    wide_mask >>= 8;
   }
 }
 
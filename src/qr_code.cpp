@@ -0,0 +1,586 @@
+#include "qr_code.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace ssd1306_pico
+{
+    namespace
+    {
+        // per error correction level and version, from the standard's table of error correction
+        // characteristics. index 0 is unused
+        constexpr uint8_t ECC_CODEWORDS_PER_BLOCK[4][MAX_QR_VERSION + 1] = {
+            {0, 7, 10, 15, 20, 26, 18, 20, 24, 30, 18},
+            {0, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26},
+            {0, 13, 22, 18, 26, 18, 24, 18, 22, 20, 24},
+            {0, 17, 28, 22, 16, 22, 28, 26, 26, 24, 28},
+        };
+
+        constexpr uint8_t ECC_BLOCK_COUNT[4][MAX_QR_VERSION + 1] = {
+            {0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4},
+            {0, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5},
+            {0, 1, 1, 2, 2, 4, 4, 6, 6, 8, 8},
+            {0, 1, 1, 2, 4, 4, 4, 5, 6, 8, 8},
+        };
+
+        // the two bits the format information uses for each level, they're not in order
+        constexpr uint8_t FORMAT_BITS[4] = {1, 0, 3, 2};
+
+        constexpr uint8_t MAX_ECC_CODEWORDS = 30;
+        constexpr uint8_t MAX_ALIGNMENTS    = 3;
+
+        uint16_t get_data_codeword_count(uint8_t version, QrErrorCorrection error_correction)
+        {
+            uint8_t level = static_cast<uint8_t>(error_correction);
+            return get_qr_codeword_count(version) - ECC_CODEWORDS_PER_BLOCK[level][version] * ECC_BLOCK_COUNT[level][version];
+        }
+
+        // centers of the alignment patterns along either axis, evenly spaced from the far edge back to 6
+        uint8_t get_alignment_positions(uint8_t version, uint8_t* positions)
+        {
+            if (version == 1)
+                return 0;
+
+            uint8_t count = version / 7 + 2;
+            uint8_t step  = (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+
+            positions[0] = 6;
+            for (uint8_t i = count - 1, position = version * 4 + 10; i >= 1; i--, position -= step)
+                positions[i] = position;
+
+            return count;
+        }
+
+        // the alignment patterns at three of the corners would overlap the finder patterns, so they're left out
+        bool is_finder_corner(uint8_t i, uint8_t j, uint8_t count)
+        {
+            return (i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0);
+        }
+
+        // product in GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1
+        uint8_t gf_multiply(uint8_t x, uint8_t y)
+        {
+            uint8_t z = 0;
+
+            for (int8_t i = 7; i >= 0; i--)
+            {
+                z = (z << 1) ^ ((z >> 7) * 0x1D);
+                z ^= ((y >> i) & 1) * x;
+            }
+
+            return z;
+        }
+
+        // Reed-Solomon generator polynomial of the given degree, highest coefficient first without the
+        // leading 1
+        void compute_divisor(uint8_t degree, uint8_t* divisor)
+        {
+            // every version and level in the tables has error correction, degree 0 is only the unused index 0
+            if (degree == 0)
+                return;
+
+            std::fill_n(divisor, degree, 0);
+            divisor[degree - 1] = 1;
+
+            uint8_t root = 1;
+            for (uint8_t i = 0; i < degree; i++)
+            {
+                for (uint8_t j = 0; j < degree; j++)
+                {
+                    divisor[j] = gf_multiply(divisor[j], root);
+                    if (j + 1 < degree)
+                        divisor[j] ^= divisor[j + 1];
+                }
+
+                root = gf_multiply(root, 0x02);
+            }
+        }
+
+        void compute_remainder(const uint8_t* data, uint8_t length, const uint8_t* divisor, uint8_t degree, uint8_t* remainder)
+        {
+            std::fill_n(remainder, degree, 0);
+
+            for (uint8_t i = 0; i < length; i++)
+            {
+                uint8_t factor = data[i] ^ remainder[0];
+
+                std::copy(remainder + 1, remainder + degree, remainder);
+                remainder[degree - 1] = 0;
+
+                for (uint8_t j = 0; j < degree; j++)
+                    remainder[j] ^= gf_multiply(divisor[j], factor);
+            }
+        }
+
+        bool get_mask_bit(uint8_t mask, uint8_t x, uint8_t y)
+        {
+            switch (mask)
+            {
+            case 0:
+                return (x + y) % 2 == 0;
+            case 1:
+                return y % 2 == 0;
+            case 2:
+                return x % 3 == 0;
+            case 3:
+                return (x + y) % 3 == 0;
+            case 4:
+                return (x / 3 + y / 2) % 2 == 0;
+            case 5:
+                return x * y % 2 + x * y % 3 == 0;
+            case 6:
+                return (x * y % 2 + x * y % 3) % 2 == 0;
+            default:
+                return ((x + y) % 2 + x * y % 3) % 2 == 0;
+            }
+        }
+
+        // the last seven run lengths of a row or column, newest first, for spotting finder-like patterns
+        class RunHistory
+        {
+        public:
+            RunHistory(uint8_t size) : _size(size)
+            {
+            }
+
+            void add(uint16_t length)
+            {
+                // the light border before the code counts towards the first run
+                if (_runs[0] == 0)
+                    length += _size;
+
+                std::copy_backward(_runs, _runs + 6, _runs + 7);
+                _runs[0] = length;
+            }
+
+            // dark-light-dark-light-dark runs of 1:1:3:1:1 with four light modules on either side
+            uint8_t count_patterns() const
+            {
+                uint16_t n = _runs[1];
+                bool core  = n > 0 && _runs[2] == n && _runs[3] == n * 3 && _runs[4] == n && _runs[5] == n;
+
+                return (core && _runs[0] >= n * 4 && _runs[6] >= n) + (core && _runs[6] >= n * 4 && _runs[0] >= n);
+            }
+
+            uint8_t terminate(bool dark, uint16_t length)
+            {
+                if (dark)
+                {
+                    add(length);
+                    length = 0;
+                }
+
+                // and so does the border after it
+                add(length + _size);
+                return count_patterns();
+            }
+
+        private:
+            uint8_t _size;
+            uint16_t _runs[7] = {};
+        };
+    }    // namespace
+
+    bool QrCode::encode(etl::string_view data, QrErrorCorrection error_correction)
+    {
+        _version          = 0;
+        _size             = 0;
+        _error_correction = error_correction;
+
+        // mode indicator, character count and the bytes, the count takes 16 bits from version 10 on
+        uint8_t version = 1;
+        for (; version <= MAX_QR_VERSION; version++)
+        {
+            uint16_t count_bits = version < 10 ? 8 : 16;
+            if (4 + count_bits + data.size() * 8 <= get_data_codeword_count(version, error_correction) * 8u)
+                break;
+        }
+
+        if (version > MAX_QR_VERSION)
+            return false;
+
+        _version = version;
+        _size    = 17 + 4 * version;
+
+        const uint16_t capacity = get_data_codeword_count(version, error_correction);
+        uint32_t bit_length     = 0;
+
+        auto append_bits = [&](uint16_t value, uint8_t length) {
+            for (int8_t i = length - 1; i >= 0; i--, bit_length++)
+            {
+                if ((value >> i) & 1)
+                    _codewords[bit_length / 8] |= 0x80 >> (bit_length % 8);
+            }
+        };
+
+        std::fill_n(_codewords, capacity, 0);
+        append_bits(0b0100, 4);
+        append_bits(data.size(), version < 10 ? 8 : 16);
+
+        for (char byte : data)
+            append_bits(static_cast<uint8_t>(byte), 8);
+
+        // up to four terminator bits, then alternating pad bytes
+        bit_length += std::min<uint32_t>(4, capacity * 8 - bit_length);
+        bit_length = (bit_length + 7) / 8 * 8;
+
+        for (uint8_t pad = 0xEC; bit_length < capacity * 8u; pad ^= 0xEC ^ 0x11)
+            append_bits(pad, 8);
+
+        _add_error_correction();
+
+        std::fill(std::begin(_modules), std::end(_modules), 0);
+        _draw_function_patterns();
+        _draw_codewords();
+
+        // the mask with the lowest penalty, each is applied and then undone by applying it again
+        uint8_t best_mask     = 0;
+        uint32_t best_penalty = UINT32_MAX;
+
+        for (uint8_t mask = 0; mask < 8; mask++)
+        {
+            _apply_mask(mask);
+            _draw_format_bits(mask);
+
+            uint32_t penalty = _get_penalty();
+            if (penalty < best_penalty)
+            {
+                best_mask    = mask;
+                best_penalty = penalty;
+            }
+
+            _apply_mask(mask);
+        }
+
+        _apply_mask(best_mask);
+        _draw_format_bits(best_mask);
+
+        return true;
+    }
+
+    uint8_t QrCode::get_version() const
+    {
+        return _version;
+    }
+
+    uint8_t QrCode::get_size() const
+    {
+        return _size;
+    }
+
+    bool QrCode::is_dark(uint8_t x, uint8_t y) const
+    {
+        uint16_t index = y * _size + x;
+        return (_modules[index / 8] >> (index % 8)) & 1;
+    }
+
+    bool QrCode::_is_function(uint8_t x, uint8_t y) const
+    {
+        // finder patterns with their separators and the format information next to them, the dark
+        // module included
+        if ((x < 9 && y < 9) || (x >= _size - 8 && y < 9) || (x < 9 && y >= _size - 8))
+            return true;
+
+        // timing patterns
+        if (x == 6 || y == 6)
+            return true;
+
+        // version information
+        if (_version >= 7 && ((x >= _size - 11 && y < 6) || (y >= _size - 11 && x < 6)))
+            return true;
+
+        uint8_t positions[MAX_ALIGNMENTS];
+        uint8_t count = get_alignment_positions(_version, positions);
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (std::abs(x - positions[i]) > 2)
+                continue;
+
+            for (uint8_t j = 0; j < count; j++)
+            {
+                if (std::abs(y - positions[j]) <= 2 && !is_finder_corner(i, j, count))
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    // codeword index in the order they're placed, the data codewords of all blocks interleaved and then
+    // their error correction codewords. the first blocks are one data codeword short of the others
+    uint8_t QrCode::_get_codeword(uint16_t index) const
+    {
+        const uint8_t level       = static_cast<uint8_t>(_error_correction);
+        const uint8_t block_count = ECC_BLOCK_COUNT[level][_version];
+        const uint8_t ecc_length  = ECC_CODEWORDS_PER_BLOCK[level][_version];
+
+        const uint16_t data_length  = get_data_codeword_count(_version, _error_correction);
+        const uint8_t short_length  = data_length / block_count;
+        const uint8_t short_blocks  = block_count - data_length % block_count;
+        const uint16_t short_region = short_length * block_count;
+
+        auto block_start = [&](uint8_t block) { return block * short_length + std::max(0, block - short_blocks); };
+
+        if (index < short_region)
+            return _codewords[block_start(index % block_count) + index / block_count];
+
+        if (index < data_length)
+            return _codewords[block_start(short_blocks + index - short_region) + short_length];
+
+        index -= data_length;
+        return _codewords[data_length + (index % block_count) * ecc_length + index / block_count];
+    }
+
+    void QrCode::_set_module(uint8_t x, uint8_t y, bool dark)
+    {
+        uint16_t index = y * _size + x;
+
+        if (dark)
+            _modules[index / 8] |= 1 << (index % 8);
+        else
+            _modules[index / 8] &= ~(1 << (index % 8));
+    }
+
+    void QrCode::_draw_function_patterns()
+    {
+        for (uint8_t i = 0; i < _size; i++)
+        {
+            _set_module(6, i, i % 2 == 0);
+            _set_module(i, 6, i % 2 == 0);
+        }
+
+        // finder patterns and their light separators
+        const uint8_t finders[3][2] = {{3, 3}, {static_cast<uint8_t>(_size - 4), 3}, {3, static_cast<uint8_t>(_size - 4)}};
+
+        for (const auto& finder : finders)
+        {
+            for (int8_t dy = -4; dy <= 4; dy++)
+            {
+                for (int8_t dx = -4; dx <= 4; dx++)
+                {
+                    int16_t x = finder[0] + dx;
+                    int16_t y = finder[1] + dy;
+
+                    if (x < 0 || y < 0 || x >= _size || y >= _size)
+                        continue;
+
+                    uint8_t distance = std::max(std::abs(dx), std::abs(dy));
+                    _set_module(x, y, distance != 2 && distance != 4);
+                }
+            }
+        }
+
+        uint8_t positions[MAX_ALIGNMENTS];
+        uint8_t count = get_alignment_positions(_version, positions);
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            for (uint8_t j = 0; j < count; j++)
+            {
+                if (is_finder_corner(i, j, count))
+                    continue;
+
+                for (int8_t dy = -2; dy <= 2; dy++)
+                {
+                    for (int8_t dx = -2; dx <= 2; dx++)
+                        _set_module(positions[i] + dx, positions[j] + dy, std::max(std::abs(dx), std::abs(dy)) != 1);
+                }
+            }
+        }
+
+        if (_version < 7)
+            return;
+
+        // version number with a (18, 6) Golay code, in a 6x3 block next to two of the finder patterns
+        uint32_t remainder = _version;
+        for (uint8_t i = 0; i < 12; i++)
+            remainder = (remainder << 1) ^ ((remainder >> 11) * 0x1F25);
+
+        uint32_t bits = static_cast<uint32_t>(_version) << 12 | remainder;
+
+        for (uint8_t i = 0; i < 18; i++)
+        {
+            bool dark = (bits >> i) & 1;
+            uint8_t a = _size - 11 + i % 3;
+            uint8_t b = i / 3;
+            _set_module(a, b, dark);
+            _set_module(b, a, dark);
+        }
+    }
+
+    void QrCode::_draw_format_bits(uint8_t mask)
+    {
+        // level and mask with a (15, 5) BCH code, xored so it's never all light
+        uint16_t data      = FORMAT_BITS[static_cast<uint8_t>(_error_correction)] << 3 | mask;
+        uint16_t remainder = data;
+        for (uint8_t i = 0; i < 10; i++)
+            remainder = (remainder << 1) ^ ((remainder >> 9) * 0x537);
+
+        uint16_t bits = (data << 10 | remainder) ^ 0x5412;
+        auto bit      = [bits](uint8_t i) { return ((bits >> i) & 1) != 0; };
+
+        // around the top left finder pattern, skipping the timing patterns
+        for (uint8_t i = 0; i < 6; i++)
+            _set_module(8, i, bit(i));
+
+        _set_module(8, 7, bit(6));
+        _set_module(8, 8, bit(7));
+        _set_module(7, 8, bit(8));
+
+        for (uint8_t i = 9; i < 15; i++)
+            _set_module(14 - i, 8, bit(i));
+
+        // and split between the other two
+        for (uint8_t i = 0; i < 8; i++)
+            _set_module(_size - 1 - i, 8, bit(i));
+
+        for (uint8_t i = 8; i < 15; i++)
+            _set_module(8, _size - 15 + i, bit(i));
+
+        _set_module(8, _size - 8, true);
+    }
+
+    void QrCode::_add_error_correction()
+    {
+        const uint8_t level       = static_cast<uint8_t>(_error_correction);
+        const uint8_t block_count = ECC_BLOCK_COUNT[level][_version];
+        const uint8_t ecc_length  = ECC_CODEWORDS_PER_BLOCK[level][_version];
+
+        const uint16_t data_length = get_data_codeword_count(_version, _error_correction);
+        const uint8_t short_length = data_length / block_count;
+        const uint8_t short_blocks = block_count - data_length % block_count;
+
+        uint8_t divisor[MAX_ECC_CODEWORDS];
+        compute_divisor(ecc_length, divisor);
+
+        const uint8_t* block = _codewords;
+        uint8_t* ecc         = _codewords + data_length;
+
+        for (uint8_t i = 0; i < block_count; i++)
+        {
+            uint8_t length = short_length + (i < short_blocks ? 0 : 1);
+            compute_remainder(block, length, divisor, ecc_length, ecc);
+
+            block += length;
+            ecc += ecc_length;
+        }
+    }
+
+    void QrCode::_draw_codewords()
+    {
+        const uint16_t bit_count = get_qr_codeword_count(_version) * 8;
+
+        uint16_t bit     = 0;
+        uint8_t codeword = 0;
+
+        // two columns at a time from the right, zigzagging up and down and stepping over the vertical
+        // timing pattern. the remainder bits after the last codeword stay light
+        for (int16_t right = _size - 1; right >= 1; right -= 2)
+        {
+            if (right == 6)
+                right = 5;
+
+            bool upward = ((right + 1) & 2) == 0;
+
+            for (uint8_t vertical = 0; vertical < _size; vertical++)
+            {
+                for (uint8_t j = 0; j < 2; j++)
+                {
+                    uint8_t x = right - j;
+                    uint8_t y = upward ? _size - 1 - vertical : vertical;
+
+                    if (_is_function(x, y) || bit >= bit_count)
+                        continue;
+
+                    if (bit % 8 == 0)
+                        codeword = _get_codeword(bit / 8);
+
+                    _set_module(x, y, (codeword >> (7 - bit % 8)) & 1);
+                    bit++;
+                }
+            }
+        }
+    }
+
+    void QrCode::_apply_mask(uint8_t mask)
+    {
+        for (uint8_t y = 0; y < _size; y++)
+        {
+            for (uint8_t x = 0; x < _size; x++)
+            {
+                if (get_mask_bit(mask, x, y) && !_is_function(x, y))
+                    _set_module(x, y, !is_dark(x, y));
+            }
+        }
+    }
+
+    // the standard's four penalty rules: long runs, 2x2 blocks, finder-like patterns and imbalance
+    uint32_t QrCode::_get_penalty() const
+    {
+        static constexpr uint8_t RUN_PENALTY     = 3;
+        static constexpr uint8_t BLOCK_PENALTY   = 3;
+        static constexpr uint8_t FINDER_PENALTY  = 40;
+        static constexpr uint8_t BALANCE_PENALTY = 10;
+
+        uint32_t penalty = 0;
+
+        // rows and then columns, with x and y swapped
+        for (uint8_t pass = 0; pass < 2; pass++)
+        {
+            for (uint8_t line = 0; line < _size; line++)
+            {
+                RunHistory history(_size);
+                bool run_dark       = false;
+                uint16_t run_length = 0;
+
+                for (uint8_t i = 0; i < _size; i++)
+                {
+                    bool dark = pass == 0 ? is_dark(i, line) : is_dark(line, i);
+
+                    if (dark == run_dark)
+                    {
+                        run_length++;
+
+                        if (run_length == 5)
+                            penalty += RUN_PENALTY;
+                        else if (run_length > 5)
+                            penalty++;
+                    }
+                    else
+                    {
+                        history.add(run_length);
+
+                        if (!run_dark)
+                            penalty += history.count_patterns() * FINDER_PENALTY;
+
+                        run_dark   = dark;
+                        run_length = 1;
+                    }
+                }
+
+                penalty += history.terminate(run_dark, run_length) * FINDER_PENALTY;
+            }
+        }
+
+        uint16_t dark_count = 0;
+
+        for (uint8_t y = 0; y < _size; y++)
+        {
+            for (uint8_t x = 0; x < _size; x++)
+            {
+                bool dark = is_dark(x, y);
+                dark_count += dark;
+
+                if (x + 1 < _size && y + 1 < _size && dark == is_dark(x + 1, y) && dark == is_dark(x, y + 1) && dark == is_dark(x + 1, y + 1))
+                    penalty += BLOCK_PENALTY;
+            }
+        }
+
+        // 10 points for every 5% the dark modules are away from half
+        int32_t total = _size * _size;
+        int32_t k     = (std::abs(dark_count * 20 - total * 10) + total - 1) / total - 1;
+
+        return penalty + k * BALANCE_PENALTY;
+    }
+}    // namespace ssd1306_pico
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "framebuffer.hpp"
+
+#include "etl/string_view.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // version 10 is 57 modules wide, the largest that fits a 64 pixel high screen with a quiet zone
+    inline constexpr uint8_t MAX_QR_VERSION = 10;
+    inline constexpr uint8_t MAX_QR_SIZE    = 17 + 4 * MAX_QR_VERSION;
+
+    // codewords a version holds, data and error correction together. the modules left over once the
+    // function patterns are placed, less the few remainder bits that don't make a whole codeword
+    constexpr uint16_t get_qr_codeword_count(uint8_t version)
+    {
+        uint16_t modules = (16 * version + 128) * version + 64;
+
+        if (version >= 2)
+        {
+            uint8_t alignment_count = version / 7 + 2;
+            modules -= (25 * alignment_count - 10) * alignment_count - 55;
+
+            if (version >= 7)
+                modules -= 36;
+        }
+
+        return modules / 8;
+    }
+
+    enum class QrErrorCorrection : uint8_t
+    {
+        LOW,         // recovers about 7% of the codewords
+        MEDIUM,      // 15%
+        QUARTILE,    // 25%
+        HIGH,        // 30%
+    };
+
+    // QR code in byte mode, encoded into a fixed module matrix in the smallest version that holds the data.
+    // the matrix is drawn straight into framebuffer page bytes, with no buffer in between
+    class QrCode
+    {
+    public:
+        QrCode()                                 = default;
+        QrCode(const QrCode& qr_code)            = default;
+        QrCode(QrCode&& qr_code)                 = default;
+        QrCode& operator=(const QrCode& qr_code) = default;
+        QrCode& operator=(QrCode&& qr_code)      = default;
+        ~QrCode()                                = default;
+
+        // false when the data doesn't fit MAX_QR_VERSION at that error correction level
+        bool encode(etl::string_view data, QrErrorCorrection error_correction = QrErrorCorrection::MEDIUM);
+
+        // 0 before a successful encode
+        [[nodiscard]] uint8_t get_version() const;
+
+        // modules per side, without the quiet zone
+        [[nodiscard]] uint8_t get_size() const;
+        [[nodiscard]] bool is_dark(uint8_t x, uint8_t y) const;
+
+        // every module is scale x scale pixels, surrounded by quiet_zone light modules. dark modules are
+        // drawn as unlit pixels on a lit background, the way readers expect them, unless inverted
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t scale = 1, uint8_t quiet_zone = 4, bool inverted = false) const;
+
+    private:
+        [[nodiscard]] bool _is_function(uint8_t x, uint8_t y) const;
+        [[nodiscard]] uint8_t _get_codeword(uint16_t index) const;
+
+        void _set_module(uint8_t x, uint8_t y, bool dark);
+        void _draw_function_patterns();
+        void _draw_format_bits(uint8_t mask);
+        void _add_error_correction();
+        void _draw_codewords();
+        void _apply_mask(uint8_t mask);
+        [[nodiscard]] uint32_t _get_penalty() const;
+
+    private:
+        uint8_t _version                    = 0;
+        uint8_t _size                       = 0;
+        QrErrorCorrection _error_correction = QrErrorCorrection::MEDIUM;
+
+        // dark modules, one bit each in row-major order
+        uint8_t _modules[(MAX_QR_SIZE * MAX_QR_SIZE + 7) / 8] = {};
+
+        // data codewords followed by the error correction codewords of each block in turn, only needed
+        // while encoding
+        uint8_t _codewords[get_qr_codeword_count(MAX_QR_VERSION)] = {};
+    };
+
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void QrCode::draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, uint8_t scale, uint8_t quiet_zone, bool inverted) const
+    {
+        if (_size == 0 || scale == 0)
+            return;
+
+        const int16_t modules = _size + 2 * quiet_zone;
+        const int16_t height  = modules * scale;
+
+        // only the columns and strips the clip lets through are built, starting at first when the symbol
+        // hangs off the left of it
+        int16_t start_x = x;
+        int16_t start_y = y;
+        int16_t end_x   = x + modules * scale;
+        int16_t end_y   = y + height;
+
+        if (!framebuffer.get_visible_rect(start_x, start_y, end_x, end_y))
+            return;
+
+        const int16_t first = start_x - x;
+        const int16_t width = end_x - start_x;
+
+        // one page byte per column, built for 8 rows at a time
+        uint8_t columns[WIDTH];
+
+        for (int16_t strip_y = (start_y - y) / 8 * 8; strip_y < end_y - y; strip_y += 8)
+        {
+            const uint8_t rows = std::min<int16_t>(height - strip_y, 8);
+
+            for (int16_t module_x = first / scale; module_x * scale < first + width; module_x++)
+            {
+                uint8_t bits = 0;
+
+                for (uint8_t row = 0; row < rows; row++)
+                {
+                    int16_t code_x = module_x - quiet_zone;
+                    int16_t code_y = (strip_y + row) / scale - quiet_zone;
+
+                    bool dark = code_x >= 0 && code_y >= 0 && code_x < _size && code_y < _size && is_dark(code_x, code_y);
+                    if (dark == inverted)
+                        bits |= 1 << row;
+                }
+
+                int16_t start = std::max<int16_t>(module_x * scale, first);
+                int16_t end   = std::min<int16_t>(module_x * scale + scale, first + width);
+                std::fill(columns + start - first, columns + end - first, bits);
+            }
+
+            framebuffer.blit_strip(x + first, y + strip_y, columns, width, rows);
+        }
+    }
+}    // namespace ssd1306_pico
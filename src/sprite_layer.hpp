@@ -0,0 +1,285 @@
+#pragma once
+
+#include "bitmap.hpp"
+#include "framebuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // Sprites composited over a static background, only the union of each changed sprite's old and new
+    // bounds is restored and redrawn, those rects end up as the target's dirty spans for the next flush
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH = 128, uint8_t HEIGHT = 64>
+    class SpriteLayer
+    {
+    public:
+        SpriteLayer(const FrameBuffer<WIDTH, HEIGHT>& background);
+        SpriteLayer(const SpriteLayer& layer)            = delete;
+        SpriteLayer(SpriteLayer&& layer)                 = delete;
+        SpriteLayer& operator=(const SpriteLayer& layer) = delete;
+        SpriteLayer& operator=(SpriteLayer&& layer)      = delete;
+        ~SpriteLayer()                                   = default;
+
+        // returns the sprite id, or -1 when the layer is full. sprites added later are drawn on top, and may
+        // hang off any edge of the screen
+        int8_t add_sprite(const Bitmap& bitmap, int16_t x, int16_t y, bool transparent = true);
+
+        // ids that add_sprite didn't return are ignored
+        void move_sprite(uint8_t id, int16_t x, int16_t y);
+        void set_sprite_bitmap(uint8_t id, const Bitmap& bitmap);
+        void set_sprite_visible(uint8_t id, bool visible);
+
+        // marks a region of the background as changed so it's restored on the next compose
+        void invalidate(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+        void invalidate_all();
+
+        void compose(FrameBuffer<WIDTH, HEIGHT>& target);
+
+    private:
+        struct Rect
+        {
+            uint8_t x;
+            uint8_t y;
+            uint8_t width;
+            uint8_t height;
+        };
+
+        struct Sprite
+        {
+            const Bitmap* bitmap;
+            int16_t x;
+            int16_t y;
+            bool is_visible;
+            bool is_transparent;
+
+            Rect drawn_rect;
+            bool is_drawn;
+            bool has_changed;
+        };
+
+        [[nodiscard]] static Rect _get_bounds(const Sprite& sprite);
+        [[nodiscard]] static bool _intersect(const Rect& a, const Rect& b, Rect& result);
+        [[nodiscard]] static Rect _merge(const Rect& a, const Rect& b);
+
+        void _add_damage(const Rect& rect);
+        void _draw_sprites(FrameBuffer<WIDTH, HEIGHT>& target, const Rect& damage) const;
+
+    private:
+        static constexpr uint8_t MAX_DAMAGE = MAX_SPRITES + 1;
+
+        const FrameBuffer<WIDTH, HEIGHT>& _background;
+
+        Sprite _sprites[MAX_SPRITES] {};
+        uint8_t _sprite_count = 0;
+
+        Rect _damage[MAX_DAMAGE] {};
+        uint8_t _damage_count = 0;
+    };
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::SpriteLayer(const FrameBuffer<WIDTH, HEIGHT>& background) : _background(background)
+    {
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    int8_t SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::add_sprite(const Bitmap& bitmap, int16_t x, int16_t y, bool transparent)
+    {
+        if (_sprite_count >= MAX_SPRITES)
+            return -1;
+
+        _sprites[_sprite_count] = Sprite {
+            .bitmap         = &bitmap,
+            .x              = x,
+            .y              = y,
+            .is_visible     = true,
+            .is_transparent = transparent,
+            .drawn_rect     = {},
+            .is_drawn       = false,
+            .has_changed    = true,
+        };
+
+        return _sprite_count++;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::move_sprite(uint8_t id, int16_t x, int16_t y)
+    {
+        if (id >= _sprite_count)
+            return;
+
+        Sprite& sprite = _sprites[id];
+
+        if (sprite.x == x && sprite.y == y)
+            return;
+
+        sprite.x           = x;
+        sprite.y           = y;
+        sprite.has_changed = true;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::set_sprite_bitmap(uint8_t id, const Bitmap& bitmap)
+    {
+        if (id >= _sprite_count)
+            return;
+
+        _sprites[id].bitmap      = &bitmap;
+        _sprites[id].has_changed = true;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::set_sprite_visible(uint8_t id, bool visible)
+    {
+        if (id >= _sprite_count)
+            return;
+
+        if (_sprites[id].is_visible == visible)
+            return;
+
+        _sprites[id].is_visible  = visible;
+        _sprites[id].has_changed = true;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::invalidate(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+    {
+        Rect screen = {0, 0, WIDTH, HEIGHT};
+        Rect rect;
+
+        if (_intersect({x, y, width, height}, screen, rect))
+            _add_damage(rect);
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::invalidate_all()
+    {
+        _damage[0]    = {0, 0, WIDTH, HEIGHT};
+        _damage_count = 1;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::compose(FrameBuffer<WIDTH, HEIGHT>& target)
+    {
+        for (uint8_t i = 0; i < _sprite_count; i++)
+        {
+            Sprite& sprite = _sprites[i];
+
+            if (!sprite.has_changed)
+                continue;
+
+            if (sprite.is_drawn)
+                _add_damage(sprite.drawn_rect);
+
+            sprite.is_drawn = sprite.is_visible;
+            if (sprite.is_visible)
+            {
+                sprite.drawn_rect = _get_bounds(sprite);
+                _add_damage(sprite.drawn_rect);
+            }
+
+            sprite.has_changed = false;
+        }
+
+        for (uint8_t i = 0; i < _damage_count; i++)
+        {
+            const Rect& damage = _damage[i];
+
+            target.copy_rect(_background, damage.x, damage.y, damage.width, damage.height);
+            _draw_sprites(target, damage);
+        }
+
+        _damage_count = 0;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    typename SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::Rect SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::_get_bounds(const Sprite& sprite)
+    {
+        // clipped to the screen, so damage rects never reach past an edge
+        int16_t start_x = std::max<int16_t>(sprite.x, 0);
+        int16_t start_y = std::max<int16_t>(sprite.y, 0);
+        int16_t end_x   = std::min<int16_t>(sprite.x + sprite.bitmap->get_width(), WIDTH);
+        int16_t end_y   = std::min<int16_t>(sprite.y + sprite.bitmap->get_height(), HEIGHT);
+
+        if (start_x >= end_x || start_y >= end_y)
+            return {0, 0, 0, 0};
+
+        return {static_cast<uint8_t>(start_x), static_cast<uint8_t>(start_y), static_cast<uint8_t>(end_x - start_x), static_cast<uint8_t>(end_y - start_y)};
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    bool SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::_intersect(const Rect& a, const Rect& b, Rect& result)
+    {
+        uint16_t start_x = std::max(a.x, b.x);
+        uint16_t start_y = std::max(a.y, b.y);
+        uint16_t end_x   = std::min(a.x + a.width, b.x + b.width);
+        uint16_t end_y   = std::min(a.y + a.height, b.y + b.height);
+
+        if (start_x >= end_x || start_y >= end_y)
+            return false;
+
+        result = {static_cast<uint8_t>(start_x), static_cast<uint8_t>(start_y), static_cast<uint8_t>(end_x - start_x), static_cast<uint8_t>(end_y - start_y)};
+        return true;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    typename SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::Rect SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::_merge(const Rect& a, const Rect& b)
+    {
+        uint8_t start_x = std::min(a.x, b.x);
+        uint8_t start_y = std::min(a.y, b.y);
+        uint16_t end_x  = std::max(a.x + a.width, b.x + b.width);
+        uint16_t end_y  = std::max(a.y + a.height, b.y + b.height);
+
+        return {start_x, start_y, static_cast<uint8_t>(end_x - start_x), static_cast<uint8_t>(end_y - start_y)};
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::_add_damage(const Rect& rect)
+    {
+        if (rect.width == 0 || rect.height == 0)
+            return;
+
+        Rect unused;
+
+        // overlapping rects are merged so no region gets restored and redrawn twice
+        for (uint8_t i = 0; i < _damage_count; i++)
+        {
+            if (_intersect(_damage[i], rect, unused))
+            {
+                Rect merged = _merge(_damage[i], rect);
+
+                _damage[i] = _damage[--_damage_count];
+                _add_damage(merged);
+                return;
+            }
+        }
+
+        // out of slots, fold into the last rect rather than dropping damage
+        if (_damage_count >= MAX_DAMAGE)
+        {
+            _damage[MAX_DAMAGE - 1] = _merge(_damage[MAX_DAMAGE - 1], rect);
+            return;
+        }
+
+        _damage[_damage_count++] = rect;
+    }
+
+    template<uint8_t MAX_SPRITES, uint8_t WIDTH, uint8_t HEIGHT>
+    void SpriteLayer<MAX_SPRITES, WIDTH, HEIGHT>::_draw_sprites(FrameBuffer<WIDTH, HEIGHT>& target, const Rect& damage) const
+    {
+        for (uint8_t i = 0; i < _sprite_count; i++)
+        {
+            const Sprite& sprite = _sprites[i];
+            Rect visible;
+
+            if (!sprite.is_drawn || !_intersect(sprite.drawn_rect, damage, visible))
+                continue;
+
+            uint8_t map_x = visible.x - sprite.x;
+            uint8_t map_y = visible.y - sprite.y;
+
+            target.draw_bitmap(visible.x, visible.y, map_x, map_y, visible.width, visible.height, *sprite.bitmap, sprite.is_transparent);
+        }
+    }
+
+}    // namespace ssd1306_pico
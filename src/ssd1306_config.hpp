@@ -5,12 +5,32 @@
 
 namespace ssd1306_pico
 {
+    // clockwise rotation of the image on the panel, ROTATE_90 and ROTATE_270 expect a portrait framebuffer
+    // flushed through DisplayController::display_rotated_framebuffer. SSD1306 only draws and renders in
+    // landscape, its text and render() aren't usable on its side
+    enum class Rotation : uint8_t
+    {
+        ROTATE_0,
+        ROTATE_90,
+        ROTATE_180,
+        ROTATE_270
+    };
+
     struct SSD1306Config
     {
         i2c_inst_t* i2c_instance;
         uint8_t sda_pin;
         uint8_t scl_pin;
         uint8_t i2c_address;
+        uint32_t i2c_baudrate = 400 * 1000;
+        bool initialize_bus   = true;    // false when the bus is shared and set up by a DisplayManager
+        Rotation rotation     = Rotation::ROTATE_0;
+        bool mirrored         = false;    // flips the image left to right, for panels seen through a mirror
+
+        // every transaction is bounded by its transfer time at i2c_baudrate plus this margin
+        uint32_t i2c_timeout_us           = 1000;
+        uint8_t i2c_max_retries           = 2;
+        uint32_t i2c_recovery_interval_us = 100 * 1000;    // how long a failed panel is left alone before it's re-initialized
     };
 
 }    // namespace ssd1306_pico
\ No newline at end of file
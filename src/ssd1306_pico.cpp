@@ -1,47 +1,119 @@
 #include "ssd1306_pico.hpp"
 
 #include "default_fonts.hpp"
-#include "util.hpp"
+#include "trace.hpp"
+#include "utf8.hpp"
 
 #include "etl/delegate.h"
-#include "etl/set.h"
 #include "etl/string.h"
 #include "etl/to_string.h"
 #include "hardware/i2c.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
 #define MAX_FORMATTED_STRING_SIZE 100
 
+// "-2147483648"
+#define MAX_NUMBER_STRING_SIZE 11
+
 namespace ssd1306_pico
 {
 
-    SSD1306::SSD1306(const SSD1306Config& config) : _display_controller(config), _framebuffer(false)
+    SSD1306::SSD1306(const SSD1306Config& config) : _display_controller(config), _canvas(false)
+    {
+        initialize();
+    }
+
+    bool SSD1306::initialize()
+    {
+        _is_initialized = _display_controller.initialize();
+        return _is_initialized;
+    }
+
+    bool SSD1306::is_initialized() const
     {
-        _display_controller.initialize();
+        return _is_initialized;
     }
 
     void SSD1306::fill()
     {
-        _framebuffer.fill();
-        _framebuffer_has_updates = true;
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::fill");
+        _canvas.fill();
     }
 
     void SSD1306::clear()
     {
-        _framebuffer.clear();
-        _framebuffer_has_updates = true;
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::clear");
+        _canvas.clear();
     }
 
-    void SSD1306::render()
+    bool SSD1306::render()
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::render");
         _render_iteration++;
 
-        if (!_framebuffer_has_updates)
-            return;
+        RenderResult result = render_page();
+        while (result == RenderResult::PAGE_SENT)
+            result = render_page();
 
-        _display_controller.display_framebuffer(_framebuffer);
-        _framebuffer_has_updates = false;
+        return result == RenderResult::DONE;
+    }
+
+    RenderResult SSD1306::render_page()
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::render_page");
+#ifdef SSD1306_PICO_DISPLAY_LIST
+        if (_canvas.is_dirty())
+        {
+            _pending_pages = 0xFF;
+            _canvas.clear_dirty();
+        }
+
+        for (uint8_t page = 0; page < get_screen_height() / 8; page++)
+        {
+            if (!(_pending_pages & (1 << page)))
+                continue;
+
+            _canvas.replay(_page_buffer, page);
+            if (!_display_controller.display_page(_page_buffer.get_data(), page, 0, get_screen_width()))
+            {
+                // the panel gets re-initialized once it answers again, so the whole frame is resent
+                _pending_pages = 0xFF;
+                return RenderResult::FAILED;
+            }
+
+            _pending_pages &= ~(1 << page);
+            return RenderResult::PAGE_SENT;
+        }
+#else
+        for (uint8_t page = 0; page < get_screen_height() / 8; page++)
+        {
+            if (!_canvas.is_dirty(page))
+                continue;
+
+            if (!_display_controller.display_framebuffer_page(_canvas, page, _canvas.get_dirty_start(page), _canvas.get_dirty_end(page)))
+            {
+                // the panel gets re-initialized once it answers again, so the whole frame is resent
+                _canvas.mark_all_dirty();
+                return RenderResult::FAILED;
+            }
+
+            _canvas.clear_dirty(page);
+            return RenderResult::PAGE_SENT;
+        }
+#endif
+
+        return RenderResult::DONE;
+    }
+
+    bool SSD1306::has_pending_updates() const
+    {
+#ifdef SSD1306_PICO_DISPLAY_LIST
+        return _canvas.is_dirty() || _pending_pages != 0;
+#else
+        return _canvas.is_dirty();
+#endif
     }
 
     DisplayController<128, 64>& SSD1306::get_display_controller()
@@ -49,6 +121,32 @@ namespace ssd1306_pico
         return _display_controller;
     }
 
+#ifndef SSD1306_PICO_DISPLAY_LIST
+    FrameBuffer<128, 64>& SSD1306::get_framebuffer()
+    {
+        return _canvas;
+    }
+#else
+    bool SSD1306::has_display_list_overflowed() const
+    {
+        return _canvas.has_overflowed();
+    }
+
+    uint16_t SSD1306::get_display_list_size() const
+    {
+        return _canvas.get_size();
+    }
+#endif
+
+    size_t SSD1306::get_render_memory_usage() const
+    {
+#ifdef SSD1306_PICO_DISPLAY_LIST
+        return sizeof(_canvas) + sizeof(_page_buffer);
+#else
+        return sizeof(_canvas);
+#endif
+    }
+
     uint8_t SSD1306::get_screen_width() const
     {
         return 128;
@@ -59,79 +157,84 @@ namespace ssd1306_pico
         return 64;
     }
 
-    void SSD1306::draw_pixel(uint8_t x, uint8_t y)
+    void SSD1306::push_clip(int16_t x, int16_t y, uint8_t width, uint8_t height)
     {
-        _framebuffer.draw_pixel(x, y);
-        _framebuffer_has_updates = true;
+        _canvas.push_clip(x, y, width, height);
     }
 
-    void SSD1306::erase_pixel(uint8_t x, uint8_t y)
+    void SSD1306::push_translation(int16_t x, int16_t y)
     {
-        _framebuffer.erase_pixel(x, y);
-        _framebuffer_has_updates = true;
+        _canvas.push_translation(x, y);
     }
 
-    void SSD1306::draw_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+    void SSD1306::push_viewport(int16_t x, int16_t y, uint8_t width, uint8_t height)
     {
-        for (uint8_t cur_x = x; cur_x < get_screen_width() && cur_x < (x + width); cur_x++)
-        {
-            for (uint8_t cur_y = y; cur_y < get_screen_height() && cur_y < (y + height); cur_y++)
-            {
-                draw_pixel(cur_x, cur_y);
-            }
-        }
+        _canvas.push_viewport(x, y, width, height);
+    }
+
+    void SSD1306::pop_clip()
+    {
+        _canvas.pop_clip();
+    }
+
+    void SSD1306::draw_pixel(int16_t x, int16_t y)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_pixel");
+        _canvas.draw_pixel(x, y);
+    }
+
+    void SSD1306::erase_pixel(int16_t x, int16_t y)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::erase_pixel");
+        _canvas.erase_pixel(x, y);
     }
 
-    void SSD1306::draw_rect_outline(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t thickness)
+    void SSD1306::draw_rect(int16_t x, int16_t y, uint8_t width, uint8_t height)
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_rect");
+        _canvas.fill_rect(x, y, width, height);
+    }
+
+    void SSD1306::draw_rect_outline(int16_t x, int16_t y, uint8_t width, uint8_t height, uint8_t thickness)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_rect_outline");
         draw_rect(x, y, width, thickness);
         draw_rect(x, y, thickness, height);
         draw_rect(x + width, y, thickness, height + thickness);
         draw_rect(x, y + height, width + thickness, thickness);
     }
 
-    void SSD1306::draw_line(uint8_t start_x, uint8_t start_y, uint8_t end_x, uint8_t end_y)
+    void SSD1306::draw_line(int16_t start_x, int16_t start_y, int16_t end_x, int16_t end_y)
     {
-        uint8_t delta_x = std::abs(end_x - start_x);
-        uint8_t delta_y = std::abs(end_y - start_y);
-
-        int8_t step_x = (start_x < end_x) ? 1 : -1;
-        int8_t step_y = (start_y < end_y) ? 1 : -1;
-
-        int8_t err = ((delta_x > delta_y) ? delta_x : -delta_y) / 2;
-        int8_t err2;
-
-        while (start_x != end_x || start_y != end_y)
-        {
-            draw_pixel(start_x, start_y);
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_line");
+        _canvas.draw_line(start_x, start_y, end_x, end_y);
+    }
 
-            err2 = err;
+    void SSD1306::draw_triangle(Point a, Point b, Point c)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_triangle");
+        _canvas.fill_triangle(a, b, c);
+    }
 
-            if (err2 > -delta_x)
-            {
-                err -= delta_y;
-                start_x += step_x;
-            }
-            if (err2 < delta_y)
-            {
-                err += delta_x;
-                start_y += step_y;
-            }
-        }
+    void SSD1306::draw_polygon(const Point* points, uint8_t count)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_polygon");
+        _canvas.fill_polygon(points, count);
     }
 
-    void SSD1306::draw_circle(uint8_t center_x, uint8_t center_y, float radius, uint8_t quality)
+    void SSD1306::draw_circle(int16_t center_x, int16_t center_y, float radius, uint8_t quality)
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_circle");
         float ang  = 0.0f;
         float step = (M_PI * 2.0f) / quality;
 
-        uint8_t last_x = center_x + radius;
-        uint8_t last_y = center_y;
+        int16_t last_x = center_x + radius;
+        int16_t last_y = center_y;
 
         for (ang = step; ang < M_PI * 2.0f + step; ang += step)
         {
-            uint8_t cur_x = center_x + std::cos(ang) * radius;
-            uint8_t cur_y = center_y + std::sin(ang) * radius;
+            int16_t cur_x = center_x + std::cos(ang) * radius;
+            int16_t cur_y = center_y + std::sin(ang) * radius;
 
             draw_line(last_x, last_y, cur_x, cur_y);
 
@@ -140,27 +243,42 @@ namespace ssd1306_pico
         }
     }
 
-    void SSD1306::draw_bitmap(uint8_t x, uint8_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap)
+    void SSD1306::draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap)
     {
-        _framebuffer.draw_bitmap(x, y, map_x, map_y, map_width, map_height, bitmap);
-        _framebuffer_has_updates = true;
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap");
+        _canvas.draw_bitmap(x, y, map_x, map_y, map_width, map_height, bitmap);
     }
 
-    void SSD1306::draw_bitmap(uint8_t x, uint8_t y, const Bitmap& bitmap)
+    void SSD1306::draw_bitmap(int16_t x, int16_t y, const Bitmap& bitmap)
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap");
         draw_bitmap(x, y, 0, 0, bitmap.get_width(), bitmap.get_height(), bitmap);
     }
 
-    void SSD1306::draw_bitmap_centered(uint8_t x, uint8_t y, const Bitmap& bitmap)
+    void SSD1306::draw_bitmap_centered(int16_t x, int16_t y, const Bitmap& bitmap)
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap_centered");
         draw_bitmap(x - bitmap.get_width() / 2, y - bitmap.get_height() / 2, 0, 0, bitmap.get_width(), bitmap.get_height(), bitmap);
     }
 
-    void SSD1306::draw_bitmap_centered(uint8_t x, uint8_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap)
+    void SSD1306::draw_bitmap_centered(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap)
     {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap_centered");
         draw_bitmap(x - bitmap.get_width() / 2, y - bitmap.get_height() / 2, map_x, map_y, map_width, map_height, bitmap);
     }
 
+    void SSD1306::draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const CompressedBitmap& bitmap)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap");
+        _canvas.draw_compressed_bitmap(x, y, map_x, map_y, map_width, map_height, bitmap);
+    }
+
+    void SSD1306::draw_bitmap(int16_t x, int16_t y, const CompressedBitmap& bitmap)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_bitmap");
+        draw_bitmap(x, y, 0, 0, bitmap.get_width(), bitmap.get_height(), bitmap);
+    }
+
     void SSD1306::set_font_size(FontSize size)
     {
         _current_font_size = size;
@@ -171,8 +289,26 @@ namespace ssd1306_pico
         return _current_font_size;
     }
 
+    void SSD1306::set_font(const Font* font)
+    {
+        _font = font;
+    }
+
+    void SSD1306::set_font_scale(uint8_t scale)
+    {
+        _font_scale = std::clamp<uint8_t>(scale, 1, MAX_BITMAP_SCALE);
+    }
+
+    uint8_t SSD1306::get_font_scale() const
+    {
+        return _font_scale;
+    }
+
     const Font& SSD1306::_get_font() const
     {
+        if (_font != nullptr)
+            return *_font;
+
         switch (_current_font_size)
         {
         case FontSize::SMALL:
@@ -186,137 +322,189 @@ namespace ssd1306_pico
         return medium_font;
     }
 
-    void SSD1306::draw_char(uint8_t x, uint8_t y, char chr)
+    uint8_t SSD1306::_get_glyph_width() const
     {
-        const Font& cur_font = _get_font();
-        const Bitmap& bitmap = cur_font.get_font_map();
+        return _get_font().get_glyph_width() * _font_scale;
+    }
 
-        chr = chr - ' ' + cur_font.get_glyph_offset();
-        if (cur_font.is_number_only())
-            chr = chr - ('0' - ' ');
+    uint8_t SSD1306::_get_glyph_height() const
+    {
+        return _get_font().get_glyph_height() * _font_scale;
+    }
 
-        uint8_t glyph_w = cur_font.get_glyph_width();
-        uint8_t glyph_h = cur_font.get_glyph_height();
+    void SSD1306::set_fallback_font(const Font* font)
+    {
+        _fallback_font = font;
+    }
 
-        uint8_t chars_per_row = cur_font.get_font_map_width() / glyph_w;
-        uint8_t glyph_y       = static_cast<uint8_t>(chr) / chars_per_row * glyph_h;
-        uint8_t glyph_x       = (chr % chars_per_row) * glyph_w;
+    void SSD1306::set_proportional(bool proportional)
+    {
+        _proportional = proportional;
+    }
 
-        draw_bitmap(x, y, glyph_x, glyph_y, glyph_w, glyph_h, bitmap);
+    bool SSD1306::is_proportional() const
+    {
+        return _proportional;
     }
 
-    void SSD1306::draw_string(uint8_t x, uint8_t y, etl::string_view str)
+    TextStyle SSD1306::get_text_style() const
     {
-        const Font& cur_font = _get_font();
+        return {.font = &_get_font(), .fallback_font = _fallback_font, .scale = _font_scale, .proportional = _proportional};
+    }
 
-        uint8_t glyph_w = cur_font.get_glyph_width();
-        uint8_t glyph_h = cur_font.get_glyph_height();
+    TextSize SSD1306::measure_text(etl::string_view str) const
+    {
+        return ssd1306_pico::measure_text(get_text_style(), str);
+    }
 
-        uint8_t cur_x = x;
-        uint8_t cur_y = y;
+    void SSD1306::_draw_glyph(int16_t x, int16_t y, const TextStyle& style, const TextGlyph& glyph)
+    {
+        if (glyph.font == nullptr || glyph.extent.width == 0)
+            return;
 
-        for (char chr : str)
-        {
-            draw_char(cur_x, cur_y, chr);
-            cur_x += glyph_w;
+        // proportional glyphs start at their first inked column
+        uint8_t glyph_x = glyph.font->get_glyph_map_x(glyph.index) + glyph.extent.left;
+        uint8_t glyph_y = glyph.font->get_glyph_map_y(glyph.index);
+        uint8_t glyph_h = glyph.font->get_glyph_height();
 
-            if (cur_x + glyph_w > get_screen_width())
-            {
-                cur_y += glyph_h;
-                cur_x = x;
-            }
-        }
+        _canvas.draw_scaled_bitmap(x, y, glyph_x, glyph_y, glyph.extent.width, glyph_h, glyph.font->get_font_map(), style.scale);
     }
 
-    void SSD1306::draw_string_centered(uint8_t x, uint8_t y, etl::string_view str)
+    int16_t SSD1306::_draw_run(int16_t x, int16_t y, const TextStyle& style, etl::string_view str)
     {
-        const Font& cur_font = _get_font();
+        const char* position = str.data();
+        const char* end      = position + str.size();
+        char32_t previous    = 0;
 
-        uint8_t glyph_w = cur_font.get_glyph_width();
-        uint8_t glyph_h = cur_font.get_glyph_height();
+        while (position < end)
+        {
+            char32_t code_point = utf8_decode(position, end);
+            TextGlyph glyph     = find_glyph(style, code_point);
 
-        uint8_t str_width = str.size() * glyph_w;
+            x += get_kerning(style, previous, code_point);
+            _draw_glyph(x, y, style, glyph);
+            x += get_glyph_advance(style, glyph);
 
-        draw_string(x - str_width / 2, y - glyph_h / 2, str);
+            previous = code_point;
+        }
+
+        return x;
     }
 
-    void SSD1306::draw_string(uint8_t x, uint8_t y, int32_t num)
+    void SSD1306::draw_char(int16_t x, int16_t y, char32_t code_point)
     {
-        const Font& cur_font = _get_font();
-
-        uint8_t glyph_w = cur_font.get_glyph_width();
-        uint8_t glyph_h = cur_font.get_glyph_height();
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_char");
+        const TextStyle style = get_text_style();
+        _draw_glyph(x, y, style, find_glyph(style, code_point));
+    }
 
-        uint8_t cur_x = x;
-        uint8_t cur_y = y;
+    void SSD1306::draw_string(int16_t x, int16_t y, etl::string_view str)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_string");
+        const TextStyle style = get_text_style();
+        uint8_t glyph_h       = _get_glyph_height();
 
-        uint8_t remaining_digits = get_digit_count(num);
-        int16_t div              = (int16_t)std::pow(10, remaining_digits - 1);
+        int16_t cur_x     = x;
+        int16_t cur_y     = y;
+        char32_t previous = 0;
 
-        while (remaining_digits > 0)
+        const char* position = str.data();
+        const char* end      = position + str.size();
+        while (position < end)
         {
-            uint8_t digit = (num / div) % 10;
-
-            draw_char(cur_x, cur_y, '0' + digit);
-            cur_x += glyph_w;
+            char32_t code_point = utf8_decode(position, end);
+            TextGlyph glyph     = find_glyph(style, code_point);
+            int16_t advance     = get_glyph_advance(style, glyph);
 
-            if (cur_x + glyph_w > get_screen_width())
+            if (cur_x != x && cur_x + advance > get_screen_width())
             {
                 cur_y += glyph_h;
-                cur_x = x;
+                cur_x    = x;
+                previous = 0;
             }
 
-            div /= 10;
-            remaining_digits--;
+            cur_x += get_kerning(style, previous, code_point);
+            _draw_glyph(cur_x, cur_y, style, glyph);
+            cur_x += advance;
+
+            previous = code_point;
         }
     }
 
-    void SSD1306::draw_string_centered(uint8_t x, uint8_t y, int32_t num)
+    void SSD1306::draw_string_centered(int16_t x, int16_t y, etl::string_view str)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_string_centered");
+        uint8_t glyph_h = _get_glyph_height();
+
+        int16_t str_width = measure_text(str).width;
+
+        draw_string(x - str_width / 2, y - glyph_h / 2, str);
+    }
+
+    void SSD1306::draw_string(int16_t x, int16_t y, int32_t num)
     {
-        const Font& cur_font = _get_font();
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_string");
 
-        uint8_t glyph_w = cur_font.get_glyph_width();
-        uint8_t glyph_h = cur_font.get_glyph_height();
+        // drawn like any other string, so the digits follow the proportional setting and kerning
+        etl::string<MAX_NUMBER_STRING_SIZE> str_buff;
+        etl::to_string(num, str_buff);
 
-        uint8_t str_width = get_digit_count(num) * glyph_w;
+        draw_string(x, y, str_buff);
+    }
 
-        draw_string(x - str_width / 2, y - glyph_h / 2, num);
+    void SSD1306::draw_string_centered(int16_t x, int16_t y, int32_t num)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_string_centered");
+
+        etl::string<MAX_NUMBER_STRING_SIZE> str_buff;
+        etl::to_string(num, str_buff);
+
+        draw_string_centered(x, y, str_buff);
     }
 
-    void SSD1306::draw_string_formatted(uint8_t x, uint8_t y, etl::string_view str, ...)
+    void SSD1306::draw_string_formatted(int16_t x, int16_t y, etl::string_view str, ...)
     {
-        static etl::set<char, 10> SPECIAL_CHARS = {'%', '\n'};
-        static etl::string<MAX_FORMATTED_STRING_SIZE> STR_BUFF;
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_string_formatted");
+
+        // on the stack rather than static, so two SSD1306 instances can draw from both cores at once
+        etl::string<MAX_FORMATTED_STRING_SIZE> str_buff;
 
-        const Font& cur_font = _get_font();
-        uint8_t glyph_w      = cur_font.get_glyph_width();
-        uint8_t glyph_h      = cur_font.get_glyph_height();
+        const TextStyle style = get_text_style();
+        uint8_t glyph_h       = _get_glyph_height();
 
-        uint8_t cur_x = x;
-        uint8_t cur_y = y;
+        int16_t cur_x     = x;
+        int16_t cur_y     = y;
+        char32_t previous = 0;
 
         va_list arglist;
         va_start(arglist, str);
 
-        for (size_t i = 0; i < str.size(); i++)
+        const char* position = str.begin();
+        while (position < str.end())
         {
-            char chr = str[i];
+            char32_t chr    = utf8_decode(position, str.end());
+            TextGlyph glyph = find_glyph(style, chr);
 
             // handle line wrapping
-            if (cur_x + glyph_w > get_screen_width())
+            if (cur_x + get_glyph_advance(style, glyph) > get_screen_width())
             {
                 cur_y += glyph_h;
-                cur_x = x;
+                cur_x    = x;
+                previous = 0;
             }
 
             // normal character
-            if (!SPECIAL_CHARS.contains(chr))
+            if (chr != '%' && chr != '\n')
             {
-                draw_char(cur_x, cur_y, chr);
-                cur_x += glyph_w;
+                cur_x += get_kerning(style, previous, chr);
+                _draw_glyph(cur_x, cur_y, style, glyph);
+                cur_x += get_glyph_advance(style, glyph);
+                previous = chr;
                 continue;
             }
 
+            previous = 0;
+
             // formatted character
             switch (chr)
             {
@@ -325,54 +513,82 @@ namespace ssd1306_pico
                 cur_x = x;
                 continue;
             case '%':
-                char chr_next = str[++i];    // skip next character as it's part of the format specifier
+                char chr_next = (position < str.end()) ? *position++ : '\0';    // skip next character as it's part of the format specifier
                 switch (chr_next)
                 {
                 case 'c':
-                    draw_char(cur_x, cur_y, va_arg(arglist, int));
-                    cur_x += glyph_w;
+                {
+                    TextGlyph argument = find_glyph(style, static_cast<unsigned char>(va_arg(arglist, int)));
+                    _draw_glyph(cur_x, cur_y, style, argument);
+                    cur_x += get_glyph_advance(style, argument);
                     break;
+                }
                 case 'd':
                 case 'i':
-                    etl::to_string(va_arg(arglist, int), STR_BUFF);
-                    draw_string(cur_x, cur_y, STR_BUFF);
-                    cur_x += glyph_w * STR_BUFF.size();
+                    etl::to_string(va_arg(arglist, int), str_buff);
+                    draw_string(cur_x, cur_y, str_buff);
+                    cur_x += get_text_advance(style, str_buff);
                     break;
                 case 'x':
-                    etl::to_string(va_arg(arglist, int), STR_BUFF, etl::format_spec().hex());
-                    draw_string(cur_x, cur_y, STR_BUFF);
-                    cur_x += glyph_w * STR_BUFF.size();
+                    etl::to_string(va_arg(arglist, int), str_buff, etl::format_spec().hex());
+                    draw_string(cur_x, cur_y, str_buff);
+                    cur_x += get_text_advance(style, str_buff);
                     break;
                 case 'f':
-                    etl::to_string(va_arg(arglist, double), STR_BUFF, etl::format_spec().precision(2));
-                    draw_string(cur_x, cur_y, STR_BUFF);
-                    cur_x += glyph_w * STR_BUFF.size();
+                    etl::to_string(va_arg(arglist, double), str_buff, etl::format_spec().precision(2));
+                    draw_string(cur_x, cur_y, str_buff);
+                    cur_x += get_text_advance(style, str_buff);
                     break;
                 case 's':
-                    STR_BUFF = va_arg(arglist, const char*);
-                    draw_string(cur_x, cur_y, STR_BUFF);
-                    cur_x += glyph_w * STR_BUFF.size();
+                    str_buff = va_arg(arglist, const char*);
+                    draw_string(cur_x, cur_y, str_buff);
+                    cur_x += get_text_advance(style, str_buff);
                     break;
                 case '%':
-                    draw_char(cur_x, cur_y, '%');
-                    cur_x += glyph_w;
+                {
+                    TextGlyph percent = find_glyph(style, U'%');
+                    _draw_glyph(cur_x, cur_y, style, percent);
+                    cur_x += get_glyph_advance(style, percent);
                     break;
                 }
+                }
             }
         }
     }
 
-    void SSD1306::erase_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height)
+    void SSD1306::draw_text(int16_t x, int16_t y, const TextLayout& layout)
     {
-        for (uint8_t cur_x = x; cur_x < get_screen_width() && cur_x < (x + width); cur_x++)
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_text");
+        const TextStyle& style = layout.get_style();
+        int16_t line_height    = get_line_height(style);
+
+        for (uint8_t line = 0; line < layout.get_line_count(); line++)
         {
-            for (uint8_t cur_y = y; cur_y < get_screen_height() && cur_y < (y + height); cur_y++)
-            {
-                erase_pixel(cur_x, cur_y);
-            }
+            int16_t line_x = x + layout.get_line(line).x;
+            int16_t line_y = y + line * line_height;
+
+            line_x = _draw_run(line_x, line_y, style, layout.get_line_text(line));
+
+            if (layout.get_line(line).ellipsis)
+                _draw_run(line_x, line_y, style, ELLIPSIS);
         }
     }
 
+    void SSD1306::draw_text(int16_t x, int16_t y, uint8_t width, uint8_t height, etl::string_view str, TextAlign align)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::draw_text");
+        TextLayout layout;
+        layout.layout(get_text_style(), str, width, height, align);
+
+        draw_text(x, y, layout);
+    }
+
+    void SSD1306::erase_rect(int16_t x, int16_t y, uint8_t width, uint8_t height)
+    {
+        SSD1306_PICO_TRACE_SCOPE("SSD1306::erase_rect");
+        _canvas.erase_rect(x, y, width, height);
+    }
+
     void SSD1306::blink_section(uint8_t blink_frequency, uint8_t blink_period, etl::delegate<void()> filled_draw_call, etl::delegate<void()> unfilled_draw_call)
     {
         if ((_render_iteration % blink_period) < blink_frequency)
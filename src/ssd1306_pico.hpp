@@ -1,15 +1,26 @@
 #pragma once
 
 #include "bitmap.hpp"
+#include "compressed_bitmap.hpp"
 #include "display_controller.hpp"
+#include "display_list.hpp"
 #include "font.hpp"
 #include "framebuffer.hpp"
 #include "ssd1306_config.hpp"
+#include "text_layout.hpp"
 
 #include "etl/delegate.h"
 #include "etl/string.h"
+#include <cstddef>
 #include <cstdint>
 
+// bytes of recorded commands. a pixel takes 5, a rect 7, a line 9 and a bitmap or glyph 17 on the RP2040 and
+// RP2350, so the default holds about 30 glyphs. a full screen of medium text needs around 3.4 KB, more than
+// the framebuffer it replaces
+#ifndef SSD1306_PICO_DISPLAY_LIST_SIZE
+#define SSD1306_PICO_DISPLAY_LIST_SIZE 512
+#endif
+
 namespace ssd1306_pico
 {
     enum class FontSize
@@ -19,6 +30,13 @@ namespace ssd1306_pico
         LARGE
     };
 
+    enum class RenderResult : uint8_t
+    {
+        PAGE_SENT,    // more dirty pages may be left
+        DONE,         // nothing was left to send
+        FAILED        // the panel stopped answering, the frame stays pending and is resent in full later
+    };
+
     class SSD1306
     {
     public:
@@ -29,53 +47,129 @@ namespace ssd1306_pico
         SSD1306& operator=(SSD1306&& ssd1306)      = delete;
         ~SSD1306()                                 = default;
 
+        // sends the init sequence again, the constructor already does. false when the panel didn't answer,
+        // it's then re-initialized on its own once i2c_recovery_interval_us has passed
+        bool initialize();
+
+        // whether the panel took the last init sequence sent by the constructor or initialize()
+        [[nodiscard]] bool is_initialized() const;
+
         void fill();
         void clear();
-        void render();
+
+        // false when the panel stopped answering before every dirty page was sent
+        bool render();
+
+        // flushes one dirty page
+        RenderResult render_page();
+        [[nodiscard]] bool has_pending_updates() const;
 
         [[nodiscard]] DisplayController<128, 64>& get_display_controller();
+#ifndef SSD1306_PICO_DISPLAY_LIST
+        [[nodiscard]] FrameBuffer<128, 64>& get_framebuffer();
+#else
+        // once a command doesn't fit, it and every draw after it are dropped until the next clear() or fill(),
+        // so a frame that reports this is incomplete
+        [[nodiscard]] bool has_display_list_overflowed() const;
+
+        // bytes recorded since the last clear() or fill(), out of SSD1306_PICO_DISPLAY_LIST_SIZE
+        [[nodiscard]] uint16_t get_display_list_size() const;
+#endif
+
+        // bytes held for rendering, the framebuffer or the display list plus its page buffer
+        [[nodiscard]] size_t get_render_memory_usage() const;
 
         [[nodiscard]] uint8_t get_screen_width() const;
         [[nodiscard]] uint8_t get_screen_height() const;
 
-        void draw_pixel(uint8_t x, uint8_t y);
-        void erase_pixel(uint8_t x, uint8_t y);
+        void push_clip(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void push_translation(int16_t x, int16_t y);
+        void push_viewport(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void pop_clip();
 
-        void draw_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
-        void draw_rect_outline(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t thickness);
+        void draw_pixel(int16_t x, int16_t y);
+        void erase_pixel(int16_t x, int16_t y);
 
-        void draw_line(uint8_t start_x, uint8_t start_y, uint8_t end_x, uint8_t end_y);
-        void draw_circle(uint8_t center_x, uint8_t center_y, float radius, uint8_t quality);
+        void draw_rect(int16_t x, int16_t y, uint8_t width, uint8_t height);
+        void draw_rect_outline(int16_t x, int16_t y, uint8_t width, uint8_t height, uint8_t thickness);
 
-        void draw_bitmap(uint8_t x, uint8_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap);
-        void draw_bitmap(uint8_t x, uint8_t y, const Bitmap& bitmap);
-        void draw_bitmap_centered(uint8_t x, uint8_t y, const Bitmap& bitmap);
-        void draw_bitmap_centered(uint8_t x, uint8_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap);
+        void draw_line(int16_t start_x, int16_t start_y, int16_t end_x, int16_t end_y);
+        void draw_triangle(Point a, Point b, Point c);
+        void draw_polygon(const Point* points, uint8_t count);
+        void draw_circle(int16_t center_x, int16_t center_y, float radius, uint8_t quality);
+
+        void draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap);
+        void draw_bitmap(int16_t x, int16_t y, const Bitmap& bitmap);
+        void draw_bitmap_centered(int16_t x, int16_t y, const Bitmap& bitmap);
+        void draw_bitmap_centered(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const Bitmap& bitmap);
+        void draw_bitmap(int16_t x, int16_t y, uint8_t map_x, uint8_t map_y, uint8_t map_width, uint8_t map_height, const CompressedBitmap& bitmap);
+        void draw_bitmap(int16_t x, int16_t y, const CompressedBitmap& bitmap);
 
         void set_font_size(FontSize size);
         [[nodiscard]] FontSize get_font_size() const;
 
-        void draw_char(uint8_t x, uint8_t y, char chr);
-        void draw_string(uint8_t x, uint8_t y, etl::string_view str);
-        void draw_string_centered(uint8_t x, uint8_t y, etl::string_view str);
-        void draw_string(uint8_t x, uint8_t y, int32_t num);
-        void draw_string_centered(uint8_t x, uint8_t y, int32_t num);
-        void draw_string_formatted(uint8_t x, uint8_t y, etl::string_view str, ...);
+        // draws text in a font of the build's own, like a subset made by tools/font_subset.cpp, instead of the
+        // one picked by the font size. nullptr goes back to the font size. the font has to outlive its use
+        void set_font(const Font* font);
+
+        // integer upscaling of the current font, 1 to MAX_BITMAP_SCALE
+        void set_font_scale(uint8_t scale);
+        [[nodiscard]] uint8_t get_font_scale() const;
+
+        // glyphs the current font lacks come from the fallback font, like symbol_font, or are left blank
+        void set_fallback_font(const Font* font);
+
+        // advance by each glyph's inked width plus LETTER_SPACING, and apply the font's kerning pairs
+        void set_proportional(bool proportional);
+        [[nodiscard]] bool is_proportional() const;
+
+        // the current font settings, for measuring and laying out text ahead of drawing it
+        [[nodiscard]] TextStyle get_text_style() const;
+        [[nodiscard]] TextSize measure_text(etl::string_view str) const;
 
-        void erase_rect(uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+        // strings are decoded as UTF-8
+        void draw_char(int16_t x, int16_t y, char32_t code_point);
+        void draw_string(int16_t x, int16_t y, etl::string_view str);
+        void draw_string_centered(int16_t x, int16_t y, etl::string_view str);
+        void draw_string(int16_t x, int16_t y, int32_t num);
+        void draw_string_centered(int16_t x, int16_t y, int32_t num);
+        void draw_string_formatted(int16_t x, int16_t y, etl::string_view str, ...);
+
+        // draws a layout with the box's top left corner at x, y, in the style it was laid out with
+        void draw_text(int16_t x, int16_t y, const TextLayout& layout);
+        void draw_text(int16_t x, int16_t y, uint8_t width, uint8_t height, etl::string_view str, TextAlign align = TextAlign::LEFT);
+
+        void erase_rect(int16_t x, int16_t y, uint8_t width, uint8_t height);
 
         void blink_section(uint8_t blink_frequency, uint8_t blink_period, etl::delegate<void()> filled_draw_call, etl::delegate<void()> unfilled_draw_call);
 
     private:
         const Font& _get_font() const;
+        uint8_t _get_glyph_width() const;
+        uint8_t _get_glyph_height() const;
+
+        void _draw_glyph(int16_t x, int16_t y, const TextStyle& style, const TextGlyph& glyph);
+        int16_t _draw_run(int16_t x, int16_t y, const TextStyle& style, etl::string_view str);
 
     private:
         DisplayController<128, 64> _display_controller;
-        FrameBuffer<128, 64> _framebuffer;
-        bool _framebuffer_has_updates = false;
+
+#ifdef SSD1306_PICO_DISPLAY_LIST
+        // draw calls are recorded and replayed page by page at render time, the whole screen is re-streamed on change
+        DisplayList<128, 64, SSD1306_PICO_DISPLAY_LIST_SIZE> _canvas;
+        FrameBuffer<128, 8> _page_buffer;
+        uint8_t _pending_pages = 0;
+#else
+        FrameBuffer<128, 64> _canvas;
+#endif
 
         FontSize _current_font_size = FontSize::MEDIUM;
+        uint8_t _font_scale         = 1;
+        const Font* _font           = nullptr;
+        const Font* _fallback_font  = nullptr;
+        bool _proportional          = false;
 
         uint8_t _render_iteration = 0;
+        bool _is_initialized      = false;
     };
 }    // namespace ssd1306_pico
\ No newline at end of file
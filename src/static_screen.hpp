@@ -0,0 +1,57 @@
+#pragma once
+
+#include "font.hpp"
+#include "framebuffer.hpp"
+#include "utf8.hpp"
+
+#include "etl/string_view.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // a page-major frame rasterized at compile time, declared constexpr it's placed in flash and can be
+    // sent to the panel as is
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    struct StaticScreen
+    {
+        uint8_t data[WIDTH * (HEIGHT / 8)];
+    };
+
+    // draws monospaced text with a font's cell width, for building screens in constant expressions.
+    // returns the x after the last glyph
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    constexpr int16_t draw_static_text(FrameBuffer<WIDTH, HEIGHT>& framebuffer, int16_t x, int16_t y, const Font& font, etl::string_view text, uint8_t scale = 1)
+    {
+        const char* position = text.data();
+        const char* end      = position + text.size();
+
+        while (position < end)
+        {
+            int16_t glyph_index = font.get_glyph_index(utf8_decode(position, end));
+
+            if (glyph_index >= 0)
+                framebuffer.draw_scaled_bitmap(x, y, font.get_glyph_map_x(glyph_index), font.get_glyph_map_y(glyph_index), font.get_glyph_width(), font.get_glyph_height(), font.get_font_map(), scale);
+
+            x += font.get_glyph_width() * scale;
+        }
+
+        return x;
+    }
+
+    // runs draw on a blank framebuffer during compilation and keeps only the pixels, so a splash or
+    // fixed layout costs nothing at startup:
+    //   constexpr auto splash = render_static<128, 64>([](FrameBuffer<128, 64>& framebuffer) { ... });
+    template<uint8_t WIDTH, uint8_t HEIGHT, typename Draw>
+    consteval StaticScreen<WIDTH, HEIGHT> render_static(Draw draw)
+    {
+        FrameBuffer<WIDTH, HEIGHT> framebuffer;
+        draw(framebuffer);
+
+        StaticScreen<WIDTH, HEIGHT> screen = {};
+        std::copy(framebuffer.get_data(), framebuffer.get_data() + WIDTH * (HEIGHT / 8), screen.data);
+
+        return screen;
+    }
+}    // namespace ssd1306_pico
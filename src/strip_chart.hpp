@@ -0,0 +1,333 @@
+#pragma once
+
+#include "framebuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    enum class TraceStyle : uint8_t
+    {
+        LINE,      // consecutive samples joined by vertical spans
+        POINTS,    // one pixel per sample
+    };
+
+    // Scrolling chart of live samples, newest on the right. Every draw shifts the chart's rect left by the
+    // samples pushed since the last one and draws only the new columns, so only the chart's own rect is
+    // marked dirty. Samples are kept in a ring buffer per trace, in whatever units the sensor reports
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES = 1>
+    class StripChart
+    {
+        static_assert(MAX_WIDTH < 255, "the ring holds MAX_WIDTH + 1 samples behind an 8-bit index");
+
+    public:
+        // widths past MAX_WIDTH and trace counts past MAX_TRACES are cut off
+        StripChart(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t trace_count = 1);
+        StripChart(const StripChart& chart)            = delete;
+        StripChart(StripChart&& chart)                 = delete;
+        StripChart& operator=(const StripChart& chart) = delete;
+        StripChart& operator=(StripChart&& chart)      = delete;
+        ~StripChart()                                  = default;
+
+        // fixed vertical range, turns autoscaling off
+        void set_range(int16_t min, int16_t max);
+
+        // fits the range to the samples on screen. the span is a power of two at least twice theirs, placed
+        // on a quarter of itself, so it only steps when a sample leaves it or the samples shrink to under a
+        // quarter of it. a new range doesn't redraw the chart, the columns drawn before it are redrawn a few
+        // per draw, newest first
+        void set_autoscale(bool autoscale);
+
+        void set_trace_style(uint8_t trace, TraceStyle style);
+
+        // values holds one sample per trace
+        void push(const int16_t* values);
+
+        // a sample for the first trace, the others repeat their last one
+        void push(int16_t value);
+
+        // forces a full redraw, like after something else drew over the chart
+        void invalidate();
+
+        [[nodiscard]] int16_t get_min() const;
+        [[nodiscard]] int16_t get_max() const;
+
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer);
+
+    private:
+        [[nodiscard]] int16_t _get_sample(uint8_t trace, uint8_t age) const;
+        [[nodiscard]] int16_t _to_y(int16_t value) const;
+
+        void _scan_samples();
+        void _fit_range();
+
+        template<uint8_t WIDTH, uint8_t HEIGHT>
+        void _draw_column(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t age) const;
+
+    private:
+        // columns drawn before a range change that each draw brings up to date
+        static constexpr uint8_t RESCALE_COLUMNS = 8;
+
+        uint8_t _x;
+        uint8_t _y;
+        uint8_t _width;
+        uint8_t _height;
+        uint8_t _trace_count;
+
+        int16_t _min    = 0;
+        int16_t _max    = 1;
+        bool _autoscale = true;
+
+        TraceStyle _styles[MAX_TRACES] = {};
+
+        // one sample more than there are columns, the oldest column still joins up with the one before it
+        int16_t _samples[MAX_TRACES][MAX_WIDTH + 1] = {};
+        uint8_t _head  = 0;    // where the next sample goes
+        uint8_t _count = 0;
+
+        // extremes of the samples on screen, kept as samples come and go
+        int16_t _sample_min = INT16_MAX;
+        int16_t _sample_max = INT16_MIN;
+
+        // samples pushed since the last draw, scrolled in on the next one
+        uint8_t _pending   = 0;
+        bool _needs_redraw = true;
+
+        // the newest columns on screen drawn with the current range
+        uint8_t _rescaled = 0;
+    };
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    StripChart<MAX_WIDTH, MAX_TRACES>::StripChart(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t trace_count)
+        : _x(x), _y(y), _width(std::min(width, MAX_WIDTH)), _height(height), _trace_count(std::min(trace_count, MAX_TRACES))
+    {
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::set_range(int16_t min, int16_t max)
+    {
+        _min          = min;
+        _max          = std::max<int32_t>(max, min + 1);
+        _autoscale    = false;
+        _needs_redraw = true;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::set_autoscale(bool autoscale)
+    {
+        _autoscale = autoscale;
+
+        if (_autoscale && _count > 0)
+            _fit_range();
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::set_trace_style(uint8_t trace, TraceStyle style)
+    {
+        if (trace >= _trace_count)
+            return;
+
+        _styles[trace] = style;
+        _needs_redraw  = true;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::push(const int16_t* values)
+    {
+        if (_width == 0)
+            return;
+
+        // the oldest column scrolls off, the extremes are only scanned for again when it held one of them
+        bool is_extreme_leaving = false;
+
+        for (uint8_t trace = 0; trace < _trace_count && _count >= _width; trace++)
+        {
+            int16_t sample     = _get_sample(trace, _width - 1);
+            is_extreme_leaving = is_extreme_leaving || sample == _sample_min || sample == _sample_max;
+        }
+
+        for (uint8_t trace = 0; trace < _trace_count; trace++)
+        {
+            _samples[trace][_head] = values[trace];
+            _sample_min            = std::min(_sample_min, values[trace]);
+            _sample_max            = std::max(_sample_max, values[trace]);
+        }
+
+        _head  = (_head + 1) % (_width + 1);
+        _count = std::min<uint8_t>(_count + 1, _width + 1);
+
+        _pending = std::min<uint8_t>(_pending + 1, _width);
+
+        if (is_extreme_leaving)
+            _scan_samples();
+
+        if (_autoscale)
+            _fit_range();
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::push(int16_t value)
+    {
+        int16_t values[MAX_TRACES] = {value};
+
+        for (uint8_t trace = 1; trace < _trace_count; trace++)
+            values[trace] = _count > 0 ? _get_sample(trace, 0) : 0;
+
+        push(values);
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::invalidate()
+    {
+        _needs_redraw = true;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    int16_t StripChart<MAX_WIDTH, MAX_TRACES>::get_min() const
+    {
+        return _min;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    int16_t StripChart<MAX_WIDTH, MAX_TRACES>::get_max() const
+    {
+        return _max;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::draw(FrameBuffer<WIDTH, HEIGHT>& framebuffer)
+    {
+        if (_height == 0)
+            return;
+
+        uint8_t visible = std::min(_count, _width);
+
+        if (_needs_redraw || _pending >= _width)
+        {
+            framebuffer.erase_rect(_x, _y, _width, _height);
+
+            for (uint8_t age = 0; age < visible; age++)
+                _draw_column(framebuffer, age);
+
+            _rescaled = visible;
+        }
+        else
+        {
+            if (_pending > 0)
+            {
+                framebuffer.scroll_region_left(_x, _y, _width, _height, _pending);
+
+                for (uint8_t age = 0; age < _pending; age++)
+                    _draw_column(framebuffer, age);
+            }
+
+            _rescaled = std::min<uint16_t>(_rescaled + _pending, visible);
+
+            for (uint8_t i = 0; i < RESCALE_COLUMNS && _rescaled < visible; i++, _rescaled++)
+            {
+                framebuffer.erase_rect(_x + _width - 1 - _rescaled, _y, 1, _height);
+                _draw_column(framebuffer, _rescaled);
+            }
+        }
+
+        _pending      = 0;
+        _needs_redraw = false;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    int16_t StripChart<MAX_WIDTH, MAX_TRACES>::_get_sample(uint8_t trace, uint8_t age) const
+    {
+        return _samples[trace][(_head + _width - age) % (_width + 1)];
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    int16_t StripChart<MAX_WIDTH, MAX_TRACES>::_to_y(int16_t value) const
+    {
+        int32_t span   = _max - _min;
+        int32_t offset = std::clamp<int32_t>(value, _min, _max) - _min;
+
+        return _y + _height - 1 - (offset * (_height - 1) + span / 2) / span;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::_scan_samples()
+    {
+        _sample_min = INT16_MAX;
+        _sample_max = INT16_MIN;
+
+        for (uint8_t trace = 0; trace < _trace_count; trace++)
+        {
+            for (uint8_t age = 0; age < std::min(_count, _width); age++)
+            {
+                int16_t sample = _get_sample(trace, age);
+                _sample_min    = std::min(_sample_min, sample);
+                _sample_max    = std::max(_sample_max, sample);
+            }
+        }
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::_fit_range()
+    {
+        int32_t data_span = _sample_max - _sample_min;
+
+        bool is_outside = _sample_min < _min || _sample_max > _max;
+        bool is_loose   = data_span * 4 < _max - _min;
+
+        if (!is_outside && !is_loose)
+            return;
+
+        // the smallest power of two at least twice the data's span, starting on a multiple of its quarter
+        // that leaves at least a quarter of it below the data
+        int32_t span = 4;
+        while (span < data_span * 2)
+            span *= 2;
+
+        int32_t quarter = span / 4;
+        int32_t center  = (_sample_min + _sample_max) / 2;
+        int32_t start   = (center - span / 2) & -quarter;
+
+        int16_t min = std::max<int32_t>(start, INT16_MIN);
+        int16_t max = std::min<int32_t>(start + span, INT16_MAX);
+
+        if (min == _min && max == _max)
+            return;
+
+        _min      = min;
+        _max      = max;
+        _rescaled = 0;
+    }
+
+    template<uint8_t MAX_WIDTH, uint8_t MAX_TRACES>
+    template<uint8_t WIDTH, uint8_t HEIGHT>
+    void StripChart<MAX_WIDTH, MAX_TRACES>::_draw_column(FrameBuffer<WIDTH, HEIGHT>& framebuffer, uint8_t age) const
+    {
+        int16_t column = _x + _width - 1 - age;
+
+        for (uint8_t trace = 0; trace < _trace_count; trace++)
+        {
+            int16_t y = _to_y(_get_sample(trace, age));
+
+            if (_styles[trace] == TraceStyle::POINTS || age + 1 >= _count)
+            {
+                framebuffer.draw_pixel(column, y);
+                continue;
+            }
+
+            // the span runs from the pixel next to the previous sample, so flat stretches stay one pixel thick
+            int16_t previous_y = _to_y(_get_sample(trace, age + 1));
+            int16_t start_y    = y;
+            int16_t end_y      = y;
+
+            if (y > previous_y)
+                start_y = previous_y + 1;
+            else if (y < previous_y)
+                end_y = previous_y - 1;
+
+            framebuffer.fill_rect(column, start_y, 1, end_y - start_y + 1);
+        }
+    }
+}    // namespace ssd1306_pico
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bitmap.hpp"
+#include "font.hpp"
+
+#include <cstdint>
+
+namespace ssd1306_pico {
+
+// symbols and accented letters missing from medium_font, in the same 5x8 cell,
+// meant as its fallback: ° ± ² ³ µ · ß ä è é ö ü Ω ← ↑ → ↓
+inline constexpr uint8_t symbol_font_buffer[] = {
+    0x02, 0x05, 0x05, 0x02, 0x00,  // U+00B0 °
+    0x44, 0x44, 0x5F, 0x44, 0x44,  // U+00B1 ±
+    0x19, 0x15, 0x12, 0x00, 0x00,  // U+00B2 ²
+    0x11, 0x15, 0x0A, 0x00, 0x00,  // U+00B3 ³
+    0xFC, 0x20, 0x40, 0x20, 0x7C,  // U+00B5 µ
+    0x00, 0x00, 0x08, 0x00, 0x00,  // U+00B7 ·
+    0x7E, 0x01, 0x49, 0x55, 0x22,  // U+00DF ß
+    0x20, 0x55, 0x54, 0x55, 0x78,  // U+00E4 ä
+    0x38, 0x55, 0x56, 0x54, 0x18,  // U+00E8 è
+    0x38, 0x54, 0x56, 0x55, 0x18,  // U+00E9 é
+    0x38, 0x45, 0x44, 0x45, 0x38,  // U+00F6 ö
+    0x3C, 0x41, 0x40, 0x21, 0x7C,  // U+00FC ü
+    0x4E, 0x71, 0x01, 0x71, 0x4E,  // U+03A9 Ω
+    0x08, 0x1C, 0x2A, 0x08, 0x08,  // U+2190 ←
+    0x04, 0x02, 0x7F, 0x02, 0x04,  // U+2191 ↑
+    0x08, 0x08, 0x2A, 0x1C, 0x08,  // U+2192 →
+    0x10, 0x20, 0x7F, 0x20, 0x10,  // U+2193 ↓
+};
+
+inline constexpr GlyphRange symbol_font_ranges[] = {
+    {0x00B0, 0x00B3, 0},
+    {0x00B5, 0x00B5, 4},
+    {0x00B7, 0x00B7, 5},
+    {0x00DF, 0x00DF, 6},
+    {0x00E4, 0x00E4, 7},
+    {0x00E8, 0x00E9, 8},
+    {0x00F6, 0x00F6, 10},
+    {0x00FC, 0x00FC, 11},
+    {0x03A9, 0x03A9, 12},
+    {0x2190, 0x2193, 13},
+};
+
+inline constexpr GlyphExtents<5, 8, 85, 8>
+    symbol_font_extents(symbol_font_buffer);
+
+inline constexpr Font symbol_font =
+    Font(5, 8, 85, 8, Bitmap(85, 8, symbol_font_buffer), symbol_font_ranges, 10,
+         nullptr, 0, symbol_font_extents.extents);
+
+} // namespace ssd1306_pico
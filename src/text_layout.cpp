@@ -0,0 +1,344 @@
+#include "text_layout.hpp"
+
+#include "utf8.hpp"
+
+#include <algorithm>
+
+namespace ssd1306_pico
+{
+    namespace
+    {
+        // proportional glyphs are followed by LETTER_SPACING, which isn't part of the width when nothing follows
+        int16_t get_trailing_spacing(const TextStyle& style, const TextGlyph& glyph)
+        {
+            if (!style.proportional || glyph.font == nullptr || glyph.extent.width == 0)
+                return 0;
+
+            return LETTER_SPACING * style.scale;
+        }
+
+        // how far the pen moves over a run, and the trailing spacing of its last glyph
+        int16_t advance_run(const TextStyle& style, const char* begin, const char* end, int16_t& spacing)
+        {
+            int16_t width     = 0;
+            char32_t previous = 0;
+
+            spacing = 0;
+
+            while (begin < end)
+            {
+                char32_t code_point = utf8_decode(begin, end);
+                TextGlyph glyph     = find_glyph(style, code_point);
+
+                width += get_kerning(style, previous, code_point) + get_glyph_advance(style, glyph);
+                spacing  = get_trailing_spacing(style, glyph);
+                previous = code_point;
+            }
+
+            return width;
+        }
+
+        int16_t measure_run(const TextStyle& style, const char* begin, const char* end)
+        {
+            int16_t spacing = 0;
+            int16_t width   = advance_run(style, begin, end, spacing);
+
+            return width - spacing;
+        }
+
+        // end of the longest prefix of begin..end whose advance is no more than max_width, trailing spaces left out.
+        // fit_width is that advance, spacing included, as something drawn after the prefix starts there
+        const char* fit_run(const TextStyle& style, const char* begin, const char* end, int16_t max_width, int16_t& fit_width)
+        {
+            const char* fit_end = begin;
+            int16_t width       = 0;
+            char32_t previous   = 0;
+
+            fit_width = 0;
+
+            while (begin < end)
+            {
+                char32_t code_point = utf8_decode(begin, end);
+
+                width += get_kerning(style, previous, code_point) + get_glyph_advance(style, code_point);
+                previous = code_point;
+
+                if (width > max_width)
+                    break;
+
+                if (code_point != ' ')
+                {
+                    fit_end   = begin;
+                    fit_width = width;
+                }
+            }
+
+            return fit_end;
+        }
+    }    // namespace
+
+    TextGlyph find_glyph(const TextStyle& style, char32_t code_point)
+    {
+        const Font* font = style.font;
+        int16_t index    = font->get_glyph_index(code_point);
+
+        if (index < 0 && style.fallback_font != nullptr)
+        {
+            font  = style.fallback_font;
+            index = font->get_glyph_index(code_point);
+        }
+
+        if (index < 0)
+            return {nullptr, -1, {0, 0}};
+
+        // monospaced glyphs draw their whole cell, blank columns included
+        GlyphExtent extent = style.proportional ? font->get_glyph_extent(index) : GlyphExtent {0, font->get_glyph_width()};
+        return {font, index, extent};
+    }
+
+    int16_t get_line_height(const TextStyle& style)
+    {
+        return style.font->get_glyph_height() * style.scale;
+    }
+
+    int16_t get_glyph_advance(const TextStyle& style, char32_t code_point)
+    {
+        // monospaced text keeps the cell width for every code point, even ones that draw nothing
+        if (!style.proportional)
+            return style.font->get_glyph_width() * style.scale;
+
+        return get_glyph_advance(style, find_glyph(style, code_point));
+    }
+
+    int16_t get_glyph_advance(const TextStyle& style, const TextGlyph& glyph)
+    {
+        if (!style.proportional)
+            return style.font->get_glyph_width() * style.scale;
+
+        if (glyph.font == nullptr)
+            return 0;
+
+        // blank glyphs are spaces, half a cell wide
+        if (glyph.extent.width == 0)
+            return (glyph.font->get_glyph_width() + 1) / 2 * style.scale;
+
+        return (glyph.extent.width + LETTER_SPACING) * style.scale;
+    }
+
+    int16_t get_kerning(const TextStyle& style, char32_t left, char32_t right)
+    {
+        if (!style.proportional || left == 0)
+            return 0;
+
+        // the pairs are the font's own, a glyph taken from the fallback font isn't kerned
+        if (style.font->get_glyph_index(left) < 0 || style.font->get_glyph_index(right) < 0)
+            return 0;
+
+        return style.font->get_kerning(left, right) * style.scale;
+    }
+
+    int16_t get_text_advance(const TextStyle& style, etl::string_view text)
+    {
+        int16_t spacing = 0;
+        return advance_run(style, text.data(), text.data() + text.size(), spacing);
+    }
+
+    TextSize measure_text(const TextStyle& style, etl::string_view text)
+    {
+        const char* position = text.data();
+        const char* end      = position + text.size();
+
+        TextSize size = {0, get_line_height(style)};
+
+        while (true)
+        {
+            const char* line_end = std::find(position, end, '\n');
+
+            size.width = std::max(size.width, measure_run(style, position, line_end));
+
+            if (line_end == end)
+                break;
+
+            size.height += get_line_height(style);
+            position = line_end + 1;
+        }
+
+        return size;
+    }
+
+    void TextLayout::layout(const TextStyle& style, etl::string_view text, uint8_t width, uint8_t height, TextAlign align, bool word_wrap, bool ellipsis)
+    {
+        _style      = style;
+        _text       = text;
+        _box_width  = width;
+        _align      = align;
+        _line_count = 0;
+        _truncated  = false;
+
+        const uint8_t max_lines = std::min<int16_t>(MAX_TEXT_LINES, height / get_line_height(style));
+
+        const char* position = text.data();
+        const char* end      = position + text.size();
+
+        while (position < end && _line_count < max_lines)
+        {
+            const char* line_begin = position;
+            const char* next_line  = end;
+
+            // the line up to its last non-space glyph, and the same at the last space it could break at
+            const char* content_end = line_begin;
+            int16_t content_width   = 0;
+            const char* break_end   = nullptr;
+            int16_t break_width     = 0;
+            const char* break_next  = nullptr;
+
+            int16_t pen_x     = 0;
+            char32_t previous = 0;
+            bool overflowed   = false;
+
+            while (position < end)
+            {
+                const char* glyph_begin = position;
+                char32_t code_point     = utf8_decode(position, end);
+
+                if (code_point == '\n')
+                {
+                    next_line = position;
+                    break;
+                }
+
+                TextGlyph glyph = find_glyph(style, code_point);
+                int16_t advance = get_kerning(style, previous, code_point) + get_glyph_advance(style, glyph);
+                int16_t spacing = get_trailing_spacing(style, glyph);
+
+                // spaces can hang past the edge, they're never drawn at the end of a line
+                if (code_point == ' ')
+                {
+                    if (previous != ' ' && content_end != line_begin)
+                    {
+                        break_end   = content_end;
+                        break_width = content_width;
+                    }
+
+                    break_next = position;
+                    pen_x += advance;
+                    previous = code_point;
+                    continue;
+                }
+
+                // a glyph at the start of the line always goes on it, so a box narrower than a glyph still
+                // advances. after leading spaces it's the pen that decides, the spaces may have filled the box.
+                // the glyph fits when its ink does, the spacing after it can hang past the edge
+                if (pen_x + advance - spacing > width && pen_x > 0)
+                {
+                    overflowed = true;
+
+                    if (word_wrap && break_end != nullptr)
+                    {
+                        content_end   = break_end;
+                        content_width = break_width;
+                        next_line     = break_next;
+                    }
+                    else
+                    {
+                        next_line = glyph_begin;
+                    }
+
+                    break;
+                }
+
+                pen_x += advance;
+                previous      = code_point;
+                content_end   = position;
+                content_width = pen_x - spacing;
+            }
+
+            position = next_line;
+
+            // without wrapping the rest of the source line is dropped
+            bool cut = false;
+            if (overflowed && !word_wrap)
+            {
+                const char* newline = std::find(position, end, '\n');
+                position            = (newline == end) ? end : newline + 1;
+                cut                 = true;
+            }
+
+            // a wrapped line continues at its next word
+            if (overflowed && word_wrap)
+            {
+                while (position < end && *position == ' ')
+                    position++;
+            }
+
+            if (position < end && _line_count + 1 == max_lines)
+                cut = true;
+
+            if (cut && ellipsis)
+            {
+                int16_t ellipsis_width = measure_text(style, ELLIPSIS).width;
+                content_end            = fit_run(style, line_begin, content_end, width - ellipsis_width, content_width);
+                content_width += ellipsis_width;
+            }
+
+            _truncated |= cut;
+            _add_line(line_begin, content_end, content_width, cut && ellipsis);
+        }
+
+        if (position < end)
+            _truncated = true;
+    }
+
+    const TextStyle& TextLayout::get_style() const
+    {
+        return _style;
+    }
+
+    etl::string_view TextLayout::get_text() const
+    {
+        return _text;
+    }
+
+    uint8_t TextLayout::get_line_count() const
+    {
+        return _line_count;
+    }
+
+    const TextLine& TextLayout::get_line(uint8_t line) const
+    {
+        return _lines[line];
+    }
+
+    etl::string_view TextLayout::get_line_text(uint8_t line) const
+    {
+        return etl::string_view(_text.data() + _lines[line].begin, _lines[line].end - _lines[line].begin);
+    }
+
+    bool TextLayout::is_truncated() const
+    {
+        return _truncated;
+    }
+
+    void TextLayout::_add_line(const char* begin, const char* end, int16_t width, bool ellipsis)
+    {
+        TextLine& line = _lines[_line_count++];
+
+        line.begin    = begin - _text.data();
+        line.end      = end - _text.data();
+        line.width    = width;
+        line.ellipsis = ellipsis;
+
+        switch (_align)
+        {
+        case TextAlign::LEFT:
+            line.x = 0;
+            break;
+        case TextAlign::CENTER:
+            line.x = (_box_width - width) / 2;
+            break;
+        case TextAlign::RIGHT:
+            line.x = _box_width - width;
+            break;
+        }
+    }
+}    // namespace ssd1306_pico
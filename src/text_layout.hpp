@@ -0,0 +1,120 @@
+#pragma once
+
+#include "font.hpp"
+
+#include "etl/string_view.h"
+
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // blank columns between glyphs of proportional text, before scaling
+    inline constexpr uint8_t LETTER_SPACING = 1;
+
+    // lines a TextLayout holds, enough for the small font on a 64 pixel high screen
+    inline constexpr uint8_t MAX_TEXT_LINES = 10;
+
+    // marks text cut off by a layout
+    inline constexpr char ELLIPSIS[] = "...";
+
+    // everything the width of a string depends on
+    struct TextStyle
+    {
+        const Font* font;
+        const Font* fallback_font = nullptr;
+        uint8_t scale             = 1;
+
+        // advance by each glyph's inked width instead of the font's cell width
+        bool proportional = false;
+    };
+
+    struct TextSize
+    {
+        int16_t width;
+        int16_t height;
+    };
+
+    // a glyph resolved against the font and its fallback, font is nullptr when neither has it. extent is the
+    // columns drawn, the whole cell unless the text is proportional
+    struct TextGlyph
+    {
+        const Font* font;
+        int16_t index;
+        GlyphExtent extent;
+    };
+
+    enum class TextAlign : uint8_t
+    {
+        LEFT,
+        CENTER,
+        RIGHT,
+    };
+
+    [[nodiscard]] TextGlyph find_glyph(const TextStyle& style, char32_t code_point);
+    [[nodiscard]] int16_t get_line_height(const TextStyle& style);
+
+    // how far the pen moves after drawing code_point, a glyph found already is passed on as it is
+    [[nodiscard]] int16_t get_glyph_advance(const TextStyle& style, char32_t code_point);
+    [[nodiscard]] int16_t get_glyph_advance(const TextStyle& style, const TextGlyph& glyph);
+
+    // offset applied before drawing right when it follows left. only proportional text is kerned, and only
+    // between glyphs of the style's own font
+    [[nodiscard]] int16_t get_kerning(const TextStyle& style, char32_t left, char32_t right);
+
+    // size of UTF-8 text without drawing it, '\n' starts a new line. the width ends at the last glyph's ink,
+    // without the LETTER_SPACING that follows it
+    [[nodiscard]] TextSize measure_text(const TextStyle& style, etl::string_view text);
+
+    // how far the pen moves over a single line of text, where whatever is drawn after it starts
+    [[nodiscard]] int16_t get_text_advance(const TextStyle& style, etl::string_view text);
+
+    struct TextLine
+    {
+        uint16_t begin;    // byte offsets into the laid out text
+        uint16_t end;
+        int16_t x;         // offset from the left of the box after alignment
+        int16_t width;
+        bool ellipsis;     // "..." follows the line
+    };
+
+    // Breaks text into lines that fit a box, once. Static labels keep their layout and only redraw it,
+    // the text has to outlive the layout
+    class TextLayout
+    {
+    public:
+        TextLayout()                                         = default;
+        TextLayout(const TextLayout& text_layout)            = default;
+        TextLayout(TextLayout&& text_layout)                 = default;
+        TextLayout& operator=(const TextLayout& text_layout) = default;
+        TextLayout& operator=(TextLayout&& text_layout)      = default;
+        ~TextLayout()                                        = default;
+
+        // wraps at spaces, or cuts words, when a line is wider than the box. text that doesn't fit is
+        // dropped, and marked with an ellipsis when enabled
+        void layout(const TextStyle& style, etl::string_view text, uint8_t width, uint8_t height, TextAlign align = TextAlign::LEFT, bool word_wrap = true, bool ellipsis = true);
+
+        [[nodiscard]] const TextStyle& get_style() const;
+        [[nodiscard]] etl::string_view get_text() const;
+
+        [[nodiscard]] uint8_t get_line_count() const;
+        [[nodiscard]] const TextLine& get_line(uint8_t line) const;
+        [[nodiscard]] etl::string_view get_line_text(uint8_t line) const;
+
+        // true when part of the text didn't fit
+        [[nodiscard]] bool is_truncated() const;
+
+    private:
+        void _add_line(const char* begin, const char* end, int16_t width, bool ellipsis);
+
+    private:
+        TextStyle _style = {.font = nullptr};
+        etl::string_view _text;
+
+        uint8_t _box_width = 0;
+        TextAlign _align   = TextAlign::LEFT;
+
+        TextLine _lines[MAX_TEXT_LINES] = {};
+        uint8_t _line_count             = 0;
+        bool _truncated                 = false;
+    };
+}    // namespace ssd1306_pico
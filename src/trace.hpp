@@ -0,0 +1,170 @@
+#pragma once
+
+// Per-call tracing of the drawing primitives and bus transactions, selected at compile time. Built with
+// SSD1306_PICO_TRACE every traced call leaves its name, call site, start and duration in a fixed ring
+// buffer that trace_dump() prints over stdio. Without it SSD1306_PICO_TRACE_SCOPE expands to nothing and
+// trace_dump() and trace_clear() are empty, so the generated code is the same as if they weren't there
+
+#ifdef SSD1306_PICO_TRACE
+
+#include "pico/time.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+// events kept, the oldest are overwritten
+#ifndef SSD1306_PICO_TRACE_SIZE
+#define SSD1306_PICO_TRACE_SIZE 256
+#endif
+
+namespace ssd1306_pico
+{
+    struct TraceEvent
+    {
+        const char* name;
+        const void* caller;    // return address of the traced call, addr2line turns it into a call site
+        uint32_t start;        // in clock ticks
+        uint32_t duration;
+        uint8_t depth;         // traced calls it ran inside of
+    };
+
+    struct TraceBuffer
+    {
+        TraceEvent events[SSD1306_PICO_TRACE_SIZE] = {};
+        uint16_t head                              = 0;    // where the next event goes
+        uint16_t count                             = 0;
+        uint32_t dropped                           = 0;    // events overwritten since the last clear
+        uint8_t depth                              = 0;
+    };
+
+    // one buffer for the whole program, written from one core and never from interrupts
+    inline TraceBuffer trace_buffer;
+
+    // the Cortex-M33 cycle counter on the RP2350, the microsecond timer where there is none. a project can
+    // define SSD1306_PICO_TRACE_CLOCK() to read something else
+    inline uint32_t trace_now()
+    {
+#if defined(SSD1306_PICO_TRACE_CLOCK)
+        return SSD1306_PICO_TRACE_CLOCK();
+#elif defined(__ARM_ARCH_8M_MAIN__)
+        static constexpr uintptr_t DWT_CYCCNT = 0xE0001004;
+        return *reinterpret_cast<volatile uint32_t*>(DWT_CYCCNT);
+#else
+        return time_us_32();
+#endif
+    }
+
+    inline const char* trace_clock_unit()
+    {
+#if defined(SSD1306_PICO_TRACE_CLOCK)
+        return "ticks";
+#elif defined(__ARM_ARCH_8M_MAIN__)
+        return "cycles";
+#else
+        return "us";
+#endif
+    }
+
+    // empties the buffer and starts the cycle counter, which the core leaves off after reset
+    inline void trace_clear()
+    {
+#if !defined(SSD1306_PICO_TRACE_CLOCK) && defined(__ARM_ARCH_8M_MAIN__)
+        static constexpr uintptr_t DEMCR    = 0xE000EDFC;
+        static constexpr uintptr_t DWT_CTRL = 0xE0001000;
+
+        *reinterpret_cast<volatile uint32_t*>(DEMCR) |= 1u << 24;      // TRCENA
+        *reinterpret_cast<volatile uint32_t*>(DWT_CTRL) |= 1u << 0;    // CYCCNTENA
+#endif
+
+        trace_buffer.head    = 0;
+        trace_buffer.count   = 0;
+        trace_buffer.dropped = 0;
+    }
+
+    // prints the buffered events oldest first, one line each. an event is written when its call returns,
+    // so nested calls come before the call they ran in and are indented by depth
+    inline void trace_dump()
+    {
+        printf("trace: %u events, %" PRIu32 " dropped, times in %s\n", trace_buffer.count, trace_buffer.dropped, trace_clock_unit());
+
+        uint16_t index = (trace_buffer.head + SSD1306_PICO_TRACE_SIZE - trace_buffer.count) % SSD1306_PICO_TRACE_SIZE;
+
+        for (uint16_t i = 0; i < trace_buffer.count; i++)
+        {
+            const TraceEvent& event = trace_buffer.events[index];
+            printf("%10" PRIu32 " %8" PRIu32 " %*s%s @%p\n", event.start, event.duration, event.depth * 2, "", event.name, event.caller);
+
+            index = (index + 1) % SSD1306_PICO_TRACE_SIZE;
+        }
+    }
+
+    // times its own lifetime. constexpr so traced functions stay usable in constant expressions, where
+    // nothing is recorded
+    class TraceScope
+    {
+    public:
+        constexpr TraceScope(const char* name, const void* caller)
+        {
+            if (std::is_constant_evaluated())
+                return;
+
+            _name   = name;
+            _caller = caller;
+            _depth  = trace_buffer.depth++;
+            _start  = trace_now();
+        }
+
+        TraceScope(const TraceScope& scope)            = delete;
+        TraceScope(TraceScope&& scope)                 = delete;
+        TraceScope& operator=(const TraceScope& scope) = delete;
+        TraceScope& operator=(TraceScope&& scope)      = delete;
+
+        constexpr ~TraceScope()
+        {
+            if (std::is_constant_evaluated())
+                return;
+
+            uint32_t end = trace_now();
+            trace_buffer.depth--;
+
+            trace_buffer.events[trace_buffer.head] = {_name, _caller, _start, end - _start, _depth};
+            trace_buffer.head                      = (trace_buffer.head + 1) % SSD1306_PICO_TRACE_SIZE;
+
+            if (trace_buffer.count < SSD1306_PICO_TRACE_SIZE)
+                trace_buffer.count++;
+            else
+                trace_buffer.dropped++;
+        }
+
+    private:
+        const char* _name   = nullptr;
+        const void* _caller = nullptr;
+        uint32_t _start     = 0;
+        uint8_t _depth      = 0;
+    };
+}    // namespace ssd1306_pico
+
+// traces the rest of the enclosing block. the return address is taken here, in the traced function, so it
+// points at the call site. once a traced function is inlined it's the return address of the function it
+// was inlined into
+#define SSD1306_PICO_TRACE_SCOPE(name) \
+    ::ssd1306_pico::TraceScope _trace_scope(name, std::is_constant_evaluated() ? nullptr : __builtin_return_address(0))
+
+#else
+
+#define SSD1306_PICO_TRACE_SCOPE(name)
+
+namespace ssd1306_pico
+{
+    inline void trace_clear()
+    {
+    }
+
+    inline void trace_dump()
+    {
+    }
+}    // namespace ssd1306_pico
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    // transposes an 8x8 bit matrix, bit j of output[i] is bit i of input[j].
+    // turns 8 page-major column bytes into 8 row bytes and back, done as three rounds of swaps on two words
+    constexpr void transpose_8x8(const uint8_t* input, uint8_t* output)
+    {
+        uint32_t high = (static_cast<uint32_t>(input[7]) << 24) | (input[6] << 16) | (input[5] << 8) | input[4];
+        uint32_t low  = (static_cast<uint32_t>(input[3]) << 24) | (input[2] << 16) | (input[1] << 8) | input[0];
+        uint32_t swap = 0;
+
+        // swap the off-diagonal bits of each 2x2, then each 2x2 of each 4x4, then the 4x4s
+        swap = (low ^ (low >> 7)) & 0x00AA00AA;
+        low  = low ^ swap ^ (swap << 7);
+        swap = (high ^ (high >> 7)) & 0x00AA00AA;
+        high = high ^ swap ^ (swap << 7);
+
+        swap = (low ^ (low >> 14)) & 0x0000CCCC;
+        low  = low ^ swap ^ (swap << 14);
+        swap = (high ^ (high >> 14)) & 0x0000CCCC;
+        high = high ^ swap ^ (swap << 14);
+
+        swap = (high & 0xF0F0F0F0) | ((low >> 4) & 0x0F0F0F0F);
+        low  = ((high << 4) & 0xF0F0F0F0) | (low & 0x0F0F0F0F);
+        high = swap;
+
+        output[0] = low & 0xFF;
+        output[1] = (low >> 8) & 0xFF;
+        output[2] = (low >> 16) & 0xFF;
+        output[3] = low >> 24;
+        output[4] = high & 0xFF;
+        output[5] = (high >> 8) & 0xFF;
+        output[6] = (high >> 16) & 0xFF;
+        output[7] = high >> 24;
+    }
+
+    // converts a row-major 1bpp image, most significant bit first with each row padded to a whole byte
+    // (the layout of PBM and most image exporters), into the page-major layout Bitmap takes.
+    // output has to hold width * ceil(height / 8) bytes
+    constexpr void row_major_to_page_major(const uint8_t* rows, uint8_t width, uint8_t height, uint8_t* output)
+    {
+        const size_t stride = (width + 7) / 8;
+
+        for (uint8_t page = 0; page < (height + 7) / 8; page++)
+        {
+            for (uint8_t group = 0; group < stride; group++)
+            {
+                uint8_t block[8]      = {};
+                uint8_t transposed[8] = {};
+
+                for (uint8_t row = 0; row < 8 && page * 8 + row < height; row++)
+                    block[row] = rows[(page * 8 + row) * stride + group];
+
+                // the leftmost pixel is the top bit of each row byte, so it comes out of the transpose last
+                transpose_8x8(block, transposed);
+
+                for (uint8_t column = 0; column < 8 && group * 8 + column < width; column++)
+                    output[page * width + group * 8 + column] = transposed[7 - column];
+            }
+        }
+    }
+
+}    // namespace ssd1306_pico
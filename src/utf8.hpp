@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ssd1306_pico
+{
+    inline constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    // decodes the code point at position and moves past it. malformed, overlong or truncated sequences
+    // decode to REPLACEMENT_CHARACTER and only skip their first byte, so decoding always moves forward
+    constexpr char32_t utf8_decode(const char*& position, const char* end)
+    {
+        uint8_t lead = static_cast<uint8_t>(*position++);
+
+        if (lead < 0x80)
+            return lead;
+
+        uint8_t length     = 0;
+        char32_t min_value = 0;
+        char32_t value     = 0;
+
+        if ((lead & 0xE0) == 0xC0)
+        {
+            length    = 2;
+            min_value = 0x80;
+            value     = lead & 0x1F;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            length    = 3;
+            min_value = 0x800;
+            value     = lead & 0x0F;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            length    = 4;
+            min_value = 0x10000;
+            value     = lead & 0x07;
+        }
+        else
+        {
+            return REPLACEMENT_CHARACTER;
+        }
+
+        if (end - position < length - 1)
+            return REPLACEMENT_CHARACTER;
+
+        for (uint8_t i = 0; i < length - 1; i++)
+        {
+            uint8_t continuation = static_cast<uint8_t>(position[i]);
+            if ((continuation & 0xC0) != 0x80)
+                return REPLACEMENT_CHARACTER;
+
+            value = (value << 6) | (continuation & 0x3F);
+        }
+
+        if (value < min_value || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF))
+            return REPLACEMENT_CHARACTER;
+
+        position += length - 1;
+        return value;
+    }
+
+    // number of code points utf8_decode yields for the range
+    constexpr size_t utf8_count(const char* begin, const char* end)
+    {
+        size_t count = 0;
+
+        while (begin < end)
+        {
+            utf8_decode(begin, end);
+            count++;
+        }
+
+        return count;
+    }
+
+}    // namespace ssd1306_pico
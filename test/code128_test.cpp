@@ -0,0 +1,302 @@
+// Code128 read back by a decoder: bar and space widths looked up in the standard's symbol table, the
+// checksum verified and code sets B and C decoded. the bars are read from the encoder and from codes drawn
+// into a FrameBuffer
+
+#include "test.hpp"
+
+#include "code128.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+namespace
+{
+    // widths of the bar, space, bar, space, bar and space of every symbol value
+    constexpr const char* SYMBOL_WIDTHS[106] = {
+        "212222", "222122", "222221", "121223", "121322", "131222", "122213", "122312", "132212", "221213", "221312",
+        "231212", "112232", "122132", "122231", "113222", "123122", "123221", "223211", "221132", "221231", "213212",
+        "223112", "312131", "311222", "321122", "321221", "312212", "322112", "322211", "212123", "212321", "232121",
+        "111323", "131123", "131321", "112313", "132113", "132311", "211313", "231113", "231311", "112133", "112331",
+        "132131", "113123", "113321", "133121", "313121", "211331", "231131", "213113", "213311", "213131", "311123",
+        "311321", "331121", "312113", "312311", "332111", "314111", "221411", "431111", "111224", "111422", "121124",
+        "121421", "141122", "141221", "112214", "112412", "122114", "122411", "142112", "142211", "241211", "221114",
+        "413111", "241112", "134111", "111242", "121142", "121241", "114212", "124112", "124211", "411212", "421112",
+        "421211", "212141", "214121", "412121", "111143", "111341", "131141", "114113", "114311", "411113", "411311",
+        "113141", "114131", "311141", "411131", "211412", "211214", "211232",
+    };
+
+    constexpr const char* STOP_WIDTHS = "2331112";
+
+    constexpr int CODE_C  = 99;
+    constexpr int CODE_B  = 100;
+    constexpr int START_B = 104;
+    constexpr int START_C = 105;
+
+    struct Decoded
+    {
+        bool is_valid = false;
+        std::string text;
+        size_t symbol_count = 0;
+    };
+
+    Decoded decode(const std::vector<bool>& bars)
+    {
+        Decoded decoded;
+
+        // widths of the alternating bars and spaces, starting with a bar
+        std::string widths;
+        for (bool bar : bars)
+        {
+
+            if (widths.size() % 2 != bar)
+                widths.push_back('0');
+
+            widths.back()++;
+        }
+
+        if (widths.size() % 6 != 1 || widths.size() < 19 || widths.compare(widths.size() - 7, 7, STOP_WIDTHS) != 0)
+            return decoded;
+
+        std::vector<int> symbols;
+        for (size_t position = 0; position + 7 < widths.size(); position += 6)
+        {
+            int value = -1;
+
+            for (int i = 0; i < 106; i++)
+            {
+                if (widths.compare(position, 6, SYMBOL_WIDTHS[i]) == 0)
+                    value = i;
+            }
+
+            if (value < 0)
+                return decoded;
+
+            symbols.push_back(value);
+        }
+
+        // weighted by position, the start symbol counting once
+        int checksum = symbols[0];
+        for (size_t i = 1; i + 1 < symbols.size(); i++)
+            checksum += i * symbols[i];
+
+        if (checksum % 103 != symbols.back())
+            return decoded;
+
+        if (symbols[0] != START_B && symbols[0] != START_C)
+            return decoded;
+
+        bool set_c = symbols[0] == START_C;
+        for (size_t i = 1; i + 1 < symbols.size(); i++)
+        {
+            int value = symbols[i];
+
+            // 99 is a digit pair in code set C, it only switches to it from code set B
+            if (set_c ? value == CODE_B : value == CODE_C)
+            {
+                set_c = !set_c;
+                continue;
+            }
+
+            if (set_c && value < 100)
+            {
+                decoded.text.push_back('0' + value / 10);
+                decoded.text.push_back('0' + value % 10);
+            }
+            else if (!set_c && value < 96)
+            {
+                decoded.text.push_back(' ' + value);
+            }
+            else
+            {
+                return decoded;
+            }
+        }
+
+        decoded.is_valid     = true;
+        decoded.symbol_count = symbols.size();
+        return decoded;
+    }
+
+    Decoded decode(const Code128& code128)
+    {
+        std::vector<bool> bars;
+        for (uint16_t module = 0; module < code128.get_width(); module++)
+            bars.push_back(code128.is_bar(module));
+
+        return decode(bars);
+    }
+
+    // the code drawn a screen width at a time, starting origin_x into the first screen and moved left by a
+    // screen between draws so the later ones start off the left edge, top_clip rows off the top and under
+    // a translation the draw position undoes. every pixel of a module on screen is read back out of the
+    // page bytes, 1 for a bar and 0 for a space, -1 when they disagree or a bar runs past the code's
+    // height, and 2 when none landed on screen
+    std::vector<int8_t> rasterize(const Code128& code128, uint8_t height, uint8_t scale, uint8_t quiet_zone, bool inverted,
+                                  uint8_t origin_x, uint8_t top_clip, int16_t translation_x, int16_t translation_y)
+    {
+        constexpr uint8_t SCREEN_WIDTH  = 128;
+        constexpr uint8_t SCREEN_HEIGHT = 64;
+
+        const int modules = code128.get_width() + 2 * quiet_zone;
+        const int pixels  = modules * scale;
+        const int bottom  = std::min(height - top_clip, +SCREEN_HEIGHT);
+
+        std::vector<int8_t> values(modules, 2);
+
+        for (int left = -origin_x; left < pixels; left += SCREEN_WIDTH)
+        {
+            // lit where the code isn't drawn, so a missing strip reads as the wrong colour somewhere
+            FrameBuffer<SCREEN_WIDTH, SCREEN_HEIGHT> framebuffer(!inverted);
+
+            framebuffer.push_translation(translation_x, translation_y);
+            code128.draw(framebuffer, -left - translation_x, -top_clip - translation_y, height, scale, quiet_zone, inverted);
+            framebuffer.pop_clip();
+
+            for (int screen_x = std::max(-left, 0); screen_x < std::min(pixels - left, +SCREEN_WIDTH); screen_x++)
+            {
+                int8_t& value = values[(left + screen_x) / scale];
+
+                for (int screen_y = 0; screen_y < SCREEN_HEIGHT; screen_y++)
+                {
+                    uint8_t byte = framebuffer.get_data()[screen_y / 8 * SCREEN_WIDTH + screen_x];
+                    bool lit     = (byte >> (screen_y % 8)) & 1;
+                    int8_t bar   = lit == inverted;
+
+                    if (screen_y >= bottom)
+                        value = bar ? -1 : value;
+                    else
+                        value = value == 2 || value == bar ? bar : -1;
+                }
+            }
+        }
+
+        return values;
+    }
+
+    void test_round_trip(std::mt19937& random)
+    {
+        // start, data and checksum take at most all but the stop symbol, switching sets only ever saves symbols
+        constexpr size_t MAX_LENGTH = MAX_CODE128_SYMBOLS - 3;
+
+        for (int pass = 0; pass < 5000; pass++)
+        {
+            std::string text;
+
+            while (text.size() < MAX_LENGTH && random() % 8 != 0)
+            {
+                // digit runs of every length, so code set C is entered and left in every position
+                if (random() % 2)
+                {
+                    for (int digits = 1 + random() % 8; digits > 0 && text.size() < MAX_LENGTH; digits--)
+                        text.push_back('0' + random() % 10);
+                }
+                else
+                {
+                    text.push_back(' ' + random() % 95);
+                }
+            }
+
+            Code128 code128;
+            CHECK(code128.encode(etl::string_view(text.data(), text.size())));
+
+            Decoded decoded = decode(code128);
+            CHECK(decoded.is_valid);
+            CHECK(decoded.text == text);
+        }
+
+        // the shortest encodings, digits alone are packed two to a symbol
+        Code128 code128;
+
+        CHECK(code128.encode("12345678"));
+        CHECK(decode(code128).symbol_count == 4 + 2);
+
+        CHECK(code128.encode("AB1234CD"));
+        CHECK(decode(code128).symbol_count == 8 + 2);
+
+        CHECK(code128.encode("AB123456CD"));
+        CHECK(decode(code128).symbol_count == 9 + 2);
+
+        CHECK(code128.encode("123ABC"));
+        CHECK(decode(code128).symbol_count == 6 + 2);
+    }
+
+    void test_rasterized(std::mt19937& random)
+    {
+        for (int pass = 0; pass < 200; pass++)
+        {
+            std::string text;
+            for (int length = 1 + random() % (MAX_CODE128_SYMBOLS - 3); length > 0; length--)
+                text.push_back(random() % 2 ? '0' + random() % 10 : ' ' + random() % 95);
+
+            Code128 code128;
+            CHECK(code128.encode(etl::string_view(text.data(), text.size())));
+
+            for (uint8_t scale = 1; scale <= 3; scale++)
+            {
+                const uint8_t quiet_zone = random() % 11;
+                const bool inverted      = random() % 2;
+                const uint8_t height     = 1 + random() % 80;
+
+                // the first draw on screen, the rest off the left, some rows off the top, with and without a
+                // translation to undo
+                uint8_t origin_x      = random() % 10;
+                uint8_t top_clip      = random() % height;
+                int16_t translation_x = pass % 2 ? static_cast<int16_t>(random() % 100) - 50 : 0;
+                int16_t translation_y = pass % 2 ? static_cast<int16_t>(random() % 60) - 30 : 0;
+
+                std::vector<int8_t> values =
+                    rasterize(code128, height, scale, quiet_zone, inverted, origin_x, top_clip, translation_x, translation_y);
+
+                // the code and its quiet zone are read from modules that filled every one of their pixels
+                std::vector<bool> bars;
+                bool is_whole = true;
+
+                for (size_t module = 0; module < values.size(); module++)
+                {
+                    bool is_quiet = module < quiet_zone || module >= values.size() - quiet_zone;
+
+                    is_whole = is_whole && (values[module] == 0 || (values[module] == 1 && !is_quiet));
+                    if (!is_quiet)
+                        bars.push_back(values[module] == 1);
+                }
+
+                CHECK(is_whole);
+
+                Decoded decoded = decode(bars);
+                CHECK(decoded.is_valid);
+                CHECK(decoded.text == text);
+            }
+        }
+    }
+
+    void test_rejected()
+    {
+        Code128 code128;
+
+        CHECK(!code128.encode("tab\there"));
+        CHECK(!code128.encode("\x80"));
+        CHECK(code128.get_width() == 0);
+
+        std::string text(MAX_CODE128_SYMBOLS - 2, 'A');
+        CHECK(!code128.encode(etl::string_view(text.data(), text.size())));
+
+        // the same length packs into code set C
+        std::string digits(MAX_CODE128_SYMBOLS - 2, '7');
+        CHECK(code128.encode(etl::string_view(digits.data(), digits.size())));
+        CHECK(decode(code128).text == digits);
+    }
+}    // namespace
+
+int main()
+{
+    std::mt19937 random(128);
+
+    test_round_trip(random);
+    test_rasterized(random);
+    test_rejected();
+
+    return test_result();
+}
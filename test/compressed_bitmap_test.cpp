@@ -0,0 +1,156 @@
+// RLE round trips, and sub-rectangle blits of compressed bitmaps checked against draw_bitmap of the raw data
+
+#include "test.hpp"
+
+#include "compressed_bitmap.hpp"
+#include "framebuffer.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+namespace
+{
+    // mostly blank and solid bytes with some noise, so the encoder sees runs of every length as well as literals
+    std::vector<uint8_t> make_image(std::mt19937& random, size_t size)
+    {
+        std::vector<uint8_t> image(size);
+
+        for (uint8_t& byte : image)
+        {
+            switch (random() % 4)
+            {
+            case 0:
+                byte = random();
+                break;
+            case 1:
+                byte = 0xFF;
+                break;
+            default:
+                byte = 0x00;
+                break;
+            }
+        }
+
+        return image;
+    }
+
+    std::vector<uint8_t> encode(const std::vector<uint8_t>& raw)
+    {
+        // worst case is one control byte per 128 literals
+        std::vector<uint8_t> encoded(raw.size() + raw.size() / 128 + 1);
+        encoded.resize(rle_encode(raw.data(), raw.size(), encoded.data(), encoded.size()));
+
+        return encoded;
+    }
+
+    void test_round_trip(std::mt19937& random)
+    {
+        for (size_t size : {1, 2, 3, 127, 128, 129, 130, 131, 257, 1024})
+        {
+            for (int pass = 0; pass < 20; pass++)
+            {
+                std::vector<uint8_t> raw     = make_image(random, size);
+                std::vector<uint8_t> encoded = encode(raw);
+                CHECK(!encoded.empty());
+
+                RleReader reader(encoded.data());
+                bool is_equal = true;
+
+                for (uint8_t byte : raw)
+                    is_equal = is_equal && reader.next() == byte;
+
+                CHECK(is_equal);
+                CHECK(reader.get_position() == encoded.data() + encoded.size());
+            }
+        }
+
+        // longest run and literal, and output that doesn't fit
+        std::vector<uint8_t> run(129, 0xAA);
+        CHECK(encode(run).size() == 2);
+
+        std::vector<uint8_t> raw(16);
+        for (size_t i = 0; i < raw.size(); i++)
+            raw[i] = i;
+
+        uint8_t small[8];
+        CHECK(rle_encode(raw.data(), raw.size(), small, sizeof(small)) == 0);
+    }
+
+    void test_skip(std::mt19937& random)
+    {
+        for (int pass = 0; pass < 200; pass++)
+        {
+            std::vector<uint8_t> raw     = make_image(random, 1 + random() % 600);
+            std::vector<uint8_t> encoded = encode(raw);
+
+            RleReader reader(encoded.data());
+            size_t position = 0;
+
+            while (position < raw.size())
+            {
+                uint16_t step = random() % 40;
+                step          = std::min<size_t>(step, raw.size() - position - 1);
+
+                reader.skip(step);
+                position += step;
+
+                CHECK(reader.next() == raw[position]);
+                position++;
+            }
+        }
+    }
+
+    void test_blits(std::mt19937& random)
+    {
+        for (int pass = 0; pass < 3000; pass++)
+        {
+            uint8_t width  = 1 + random() % 128;
+            uint8_t height = 1 + random() % 64;
+
+            std::vector<uint8_t> raw     = make_image(random, Bitmap::get_buffer_size(width, height));
+            std::vector<uint8_t> encoded = encode(raw);
+
+            Bitmap bitmap(width, height, raw.data());
+            CompressedBitmap compressed(width, height, encoded.data());
+
+            FrameBuffer<128, 64> expected;
+            FrameBuffer<128, 64> actual;
+
+            for (int i = 0; i < 64; i++)
+            {
+                int16_t x = random() % 128;
+                int16_t y = random() % 64;
+
+                expected.draw_pixel(x, y);
+                actual.draw_pixel(x, y);
+            }
+
+            // partly off every edge of the screen as well
+            int16_t x          = static_cast<int16_t>(random() % 160) - 16;
+            int16_t y          = static_cast<int16_t>(random() % 96) - 16;
+            uint8_t map_x      = random() % width;
+            uint8_t map_y      = random() % height;
+            uint8_t map_width  = 1 + random() % width;
+            uint8_t map_height = 1 + random() % height;
+            bool transparent   = random() % 2;
+
+            expected.draw_bitmap(x, y, map_x, map_y, map_width, map_height, bitmap, transparent);
+            actual.draw_compressed_bitmap(x, y, map_x, map_y, map_width, map_height, compressed, transparent);
+
+            CHECK(std::equal(expected.get_data(), expected.get_data() + 128 * 64 / 8, actual.get_data()));
+        }
+    }
+}    // namespace
+
+int main()
+{
+    std::mt19937 random(28);
+
+    test_round_trip(random);
+    test_skip(random);
+    test_blits(random);
+
+    return test_result();
+}
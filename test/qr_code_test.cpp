@@ -0,0 +1,469 @@
+// QR codes read back by a decoder written from the standard: format and version information BCH, the
+// codewords de-interleaved into their blocks, Reed-Solomon syndromes, and the byte mode payload. the
+// modules are read from the encoder and from symbols drawn into a FrameBuffer
+
+#include "test.hpp"
+
+#include "qr_code.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+namespace
+{
+    // per level and version, index 0 unused. levels are in QrErrorCorrection order
+    constexpr uint8_t ECC_CODEWORDS_PER_BLOCK[4][11] = {
+        {0, 7, 10, 15, 20, 26, 18, 20, 24, 30, 18},
+        {0, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26},
+        {0, 13, 22, 18, 26, 18, 24, 18, 22, 20, 24},
+        {0, 17, 28, 22, 16, 22, 28, 26, 26, 24, 28},
+    };
+
+    constexpr uint8_t ECC_BLOCK_COUNT[4][11] = {
+        {0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4},
+        {0, 1, 1, 1, 2, 2, 4, 4, 4, 5, 5},
+        {0, 1, 1, 2, 2, 4, 4, 6, 6, 8, 8},
+        {0, 1, 1, 2, 4, 4, 4, 5, 6, 8, 8},
+    };
+
+    // bytes version 10 holds at each level
+    constexpr uint16_t VERSION_10_CAPACITY[4] = {271, 213, 151, 119};
+
+    // the level as the format information encodes it, indexed by those two bits
+    constexpr QrErrorCorrection FORMAT_LEVELS[4] = {QrErrorCorrection::MEDIUM, QrErrorCorrection::LOW, QrErrorCorrection::HIGH,
+                                                    QrErrorCorrection::QUARTILE};
+
+    struct Decoded
+    {
+        bool is_valid = false;
+        QrErrorCorrection error_correction;
+        std::string payload;
+    };
+
+    uint32_t get_bch(uint32_t data, uint8_t data_bits, uint32_t generator, uint8_t check_bits)
+    {
+        uint32_t remainder = data << check_bits;
+
+        for (int8_t bit = data_bits + check_bits - 1; bit >= check_bits; bit--)
+        {
+            if (remainder & (1u << bit))
+                remainder ^= generator << (bit - check_bits);
+        }
+
+        return data << check_bits | remainder;
+    }
+
+    uint8_t gf_multiply(uint8_t x, uint8_t y)
+    {
+        uint8_t product = 0;
+
+        for (; y != 0; y >>= 1)
+        {
+            if (y & 1)
+                product ^= x;
+
+            x = (x << 1) ^ (x & 0x80 ? 0x1D : 0);
+        }
+
+        return product;
+    }
+
+    bool is_masked(uint8_t mask, int x, int y)
+    {
+        switch (mask)
+        {
+        case 0:
+            return (x + y) % 2 == 0;
+        case 1:
+            return y % 2 == 0;
+        case 2:
+            return x % 3 == 0;
+        case 3:
+            return (x + y) % 3 == 0;
+        case 4:
+            return (x / 3 + y / 2) % 2 == 0;
+        case 5:
+            return x * y % 2 + x * y % 3 == 0;
+        case 6:
+            return (x * y % 2 + x * y % 3) % 2 == 0;
+        default:
+            return ((x + y) % 2 + x * y % 3) % 2 == 0;
+        }
+    }
+
+    // the finder patterns with their separators and format information, timing patterns, alignment
+    // patterns and version information. everything else holds codewords
+    std::vector<bool> get_function_modules(int version)
+    {
+        const int size = 17 + 4 * version;
+        std::vector<bool> function(size * size);
+
+        auto mark = [&](int x, int y, int width, int height) {
+            for (int j = y; j < y + height; j++)
+                for (int i = x; i < x + width; i++)
+                    function[j * size + i] = true;
+        };
+
+        mark(0, 0, 9, 9);
+        mark(size - 8, 0, 8, 9);
+        mark(0, size - 8, 9, 8);
+        mark(6, 0, 1, size);
+        mark(0, 6, size, 1);
+
+        if (version >= 2)
+        {
+            int count = version / 7 + 2;
+            int step  = (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+            std::vector<int> positions(count);
+
+            positions[0] = 6;
+            for (int i = count - 1, position = size - 7; i >= 1; i--, position -= step)
+                positions[i] = position;
+
+            for (int i = 0; i < count; i++)
+            {
+                for (int j = 0; j < count; j++)
+                {
+                    if ((i == 0 && j == 0) || (i == 0 && j == count - 1) || (i == count - 1 && j == 0))
+                        continue;
+
+                    mark(positions[i] - 2, positions[j] - 2, 5, 5);
+                }
+            }
+        }
+
+        if (version >= 7)
+        {
+            mark(size - 11, 0, 3, 6);
+            mark(0, size - 11, 6, 3);
+        }
+
+        return function;
+    }
+
+    // dark(x, y) reads the module at x, y of a symbol size modules across
+    template<typename Dark>
+    Decoded decode(int size, Dark dark)
+    {
+        Decoded decoded;
+
+        const int version = (size - 17) / 4;
+        if (size < 21 || (size - 17) % 4 != 0 || version > MAX_QR_VERSION)
+            return decoded;
+
+        // both copies of the format information, the second split between the other two finders
+        uint32_t format        = 0;
+        uint32_t format_mirror = 0;
+
+        for (int i = 0; i < 15; i++)
+        {
+            bool bit        = i < 6 ? dark(8, i) : i < 8 ? dark(8, i + 1) : i == 8 ? dark(7, 8) : dark(14 - i, 8);
+            bool mirror_bit = i < 8 ? dark(size - 1 - i, 8) : dark(8, size - 15 + i);
+
+            format |= bit << i;
+            format_mirror |= mirror_bit << i;
+        }
+
+        format ^= 0x5412;
+        format_mirror ^= 0x5412;
+
+        if (format != format_mirror || get_bch(format >> 10, 5, 0x537, 10) != format || !dark(8, size - 8))
+            return decoded;
+
+        const uint8_t level = static_cast<uint8_t>(FORMAT_LEVELS[format >> 13]);
+        const uint8_t mask  = (format >> 10) & 7;
+
+        // version information, above the bottom left finder and transposed left of the top right one
+        if (version >= 7)
+        {
+            uint32_t bits       = 0;
+            uint32_t transposed = 0;
+
+            for (int i = 0; i < 18; i++)
+            {
+                bits |= dark(size - 11 + i % 3, i / 3) << i;
+                transposed |= dark(i / 3, size - 11 + i % 3) << i;
+            }
+
+            if (bits != transposed || get_bch(version, 6, 0x1F25, 12) != bits)
+                return decoded;
+        }
+
+        // codewords in the zigzag order, two columns at a time from the right skipping the vertical timing
+        // pattern, unmasked as they're read
+        std::vector<bool> function = get_function_modules(version);
+        std::vector<uint8_t> codewords;
+        int bit_count = 0;
+
+        for (int right = size - 1; right >= 1; right -= 2)
+        {
+            if (right == 6)
+                right = 5;
+
+            for (int vertical = 0; vertical < size; vertical++)
+            {
+                for (int j = 0; j < 2; j++)
+                {
+                    int x       = right - j;
+                    bool upward = ((right + 1) & 2) == 0;
+                    int y       = upward ? size - 1 - vertical : vertical;
+
+                    if (function[y * size + x])
+                        continue;
+
+                    if (bit_count % 8 == 0)
+                        codewords.push_back(0);
+
+                    codewords.back() |= (dark(x, y) != is_masked(mask, x, y)) << (7 - bit_count % 8);
+                    bit_count++;
+                }
+            }
+        }
+
+        // remainder bits past the last whole codeword
+        codewords.resize(bit_count / 8);
+
+        // the blocks were interleaved a codeword at a time, the longer blocks carry one more data codeword
+        const int block_count = ECC_BLOCK_COUNT[level][version];
+        const int ecc_length  = ECC_CODEWORDS_PER_BLOCK[level][version];
+        const int short_count = block_count - codewords.size() % block_count;
+        const int short_data  = codewords.size() / block_count - ecc_length;
+
+        std::vector<std::vector<uint8_t>> blocks(block_count);
+        size_t position = 0;
+
+        for (int i = 0; i < short_data + 1; i++)
+        {
+            for (int block = 0; block < block_count; block++)
+            {
+                if (i < short_data || block >= short_count)
+                    blocks[block].push_back(codewords[position++]);
+            }
+        }
+
+        for (int i = 0; i < ecc_length; i++)
+        {
+            for (int block = 0; block < block_count; block++)
+                blocks[block].push_back(codewords[position++]);
+        }
+
+        if (position != codewords.size())
+            return decoded;
+
+        // every syndrome is zero for an error free block, the generator's roots are 2^0 to 2^(ecc_length - 1)
+        std::vector<uint8_t> data;
+        uint8_t root = 1;
+
+        for (int i = 0; i < ecc_length; i++, root = gf_multiply(root, 2))
+        {
+            for (const std::vector<uint8_t>& block : blocks)
+            {
+                uint8_t syndrome = 0;
+
+                for (uint8_t codeword : block)
+                    syndrome = gf_multiply(syndrome, root) ^ codeword;
+
+                if (syndrome != 0)
+                    return decoded;
+            }
+        }
+
+        for (const std::vector<uint8_t>& block : blocks)
+            data.insert(data.end(), block.begin(), block.end() - ecc_length);
+
+        // byte mode, then a terminator of up to four zero bits, zero bits to the next byte and pad bytes
+        size_t bit = 0;
+        auto read  = [&](int count) {
+            uint32_t value = 0;
+
+            for (int i = 0; i < count; i++, bit++)
+                value = value << 1 | (bit < data.size() * 8 ? (data[bit / 8] >> (7 - bit % 8)) & 1 : 0);
+
+            return value;
+        };
+
+        if (read(4) != 0b0100)
+            return decoded;
+
+        uint32_t length = read(version < 10 ? 8 : 16);
+        if (bit + length * 8 > data.size() * 8)
+            return decoded;
+
+        for (uint32_t i = 0; i < length; i++)
+            decoded.payload.push_back(read(8));
+
+        size_t terminator = std::min<size_t>(4, data.size() * 8 - bit);
+        if (read(terminator) != 0 || read((8 - bit % 8) % 8) != 0)
+            return decoded;
+
+        for (uint8_t pad = 0xEC; bit < data.size() * 8; pad ^= 0xEC ^ 0x11)
+        {
+            if (read(8) != pad)
+                return decoded;
+        }
+
+        decoded.is_valid         = true;
+        decoded.error_correction = static_cast<QrErrorCorrection>(level);
+        return decoded;
+    }
+
+    Decoded decode(const QrCode& qr_code)
+    {
+        if (qr_code.get_size() != 17 + 4 * qr_code.get_version())
+            return {};
+
+        return decode(qr_code.get_size(), [&](int x, int y) { return qr_code.is_dark(x, y); });
+    }
+
+    // the symbol drawn a screenful at a time, its corner at origin_x, origin_y on the first screen and
+    // moved left and up by a screen between draws so the later ones start off the top left, under a
+    // translation the draw position undoes. every pixel of a module is read back out of the page bytes,
+    // 1 for dark and 0 for light, -1 when they disagree and 2 when none landed on screen
+    std::vector<int8_t> rasterize(const QrCode& qr_code, uint8_t scale, uint8_t quiet_zone, bool inverted, uint8_t origin_x,
+                                  uint8_t origin_y, int16_t translation_x, int16_t translation_y)
+    {
+        constexpr uint8_t SCREEN_WIDTH  = 128;
+        constexpr uint8_t SCREEN_HEIGHT = 64;
+
+        const int modules = qr_code.get_size() + 2 * quiet_zone;
+        const int pixels  = modules * scale;
+
+        std::vector<int8_t> values(modules * modules, 2);
+
+        for (int top = -origin_y; top < pixels; top += SCREEN_HEIGHT)
+        {
+            for (int left = -origin_x; left < pixels; left += SCREEN_WIDTH)
+            {
+                // lit where the symbol isn't drawn, so a missing strip reads as the wrong colour somewhere
+                FrameBuffer<SCREEN_WIDTH, SCREEN_HEIGHT> framebuffer(!inverted);
+
+                framebuffer.push_translation(translation_x, translation_y);
+                qr_code.draw(framebuffer, -left - translation_x, -top - translation_y, scale, quiet_zone, inverted);
+                framebuffer.pop_clip();
+
+                for (int screen_y = std::max(-top, 0); screen_y < std::min(pixels - top, +SCREEN_HEIGHT); screen_y++)
+                {
+                    for (int screen_x = std::max(-left, 0); screen_x < std::min(pixels - left, +SCREEN_WIDTH); screen_x++)
+                    {
+                        uint8_t byte = framebuffer.get_data()[screen_y / 8 * SCREEN_WIDTH + screen_x];
+                        bool lit     = (byte >> (screen_y % 8)) & 1;
+
+                        int8_t& value = values[(top + screen_y) / scale * modules + (left + screen_x) / scale];
+                        int8_t dark   = lit == inverted;
+
+                        value = value == 2 || value == dark ? dark : -1;
+                    }
+                }
+            }
+        }
+
+        return values;
+    }
+
+    void test_round_trip(std::mt19937& random)
+    {
+        for (uint8_t level = 0; level < 4; level++)
+        {
+            auto error_correction = static_cast<QrErrorCorrection>(level);
+
+            for (int pass = 0; pass < 150; pass++)
+            {
+                std::string text(random() % (VERSION_10_CAPACITY[level] + 20), ' ');
+                for (char& character : text)
+                    character = random();
+
+                QrCode qr_code;
+                bool is_encoded = qr_code.encode(etl::string_view(text.data(), text.size()), error_correction);
+
+                CHECK(is_encoded == (text.size() <= VERSION_10_CAPACITY[level]));
+                if (!is_encoded)
+                    continue;
+
+                Decoded decoded = decode(qr_code);
+                CHECK(decoded.is_valid);
+                CHECK(decoded.error_correction == error_correction);
+                CHECK(decoded.payload == text);
+            }
+        }
+
+        // every version
+        for (uint8_t version = 1; version <= MAX_QR_VERSION; version++)
+        {
+            // bytes versions 1 to 9 hold at the low level
+            constexpr uint16_t CAPACITY[] = {0, 17, 32, 53, 78, 106, 134, 154, 192, 230, 271};
+
+            QrCode qr_code;
+            std::string text(CAPACITY[version], 'a' + version);
+
+            CHECK(qr_code.encode(etl::string_view(text.data(), text.size()), QrErrorCorrection::LOW));
+            CHECK(qr_code.get_version() == version);
+            CHECK(decode(qr_code).payload == text);
+        }
+    }
+
+    void test_rasterized(std::mt19937& random)
+    {
+        for (int pass = 0; pass < 40; pass++)
+        {
+            auto error_correction = static_cast<QrErrorCorrection>(random() % 4);
+
+            std::string text(random() % (VERSION_10_CAPACITY[static_cast<uint8_t>(error_correction)] + 1), ' ');
+            for (char& character : text)
+                character = random();
+
+            QrCode qr_code;
+            CHECK(qr_code.encode(etl::string_view(text.data(), text.size()), error_correction));
+
+            for (uint8_t scale = 1; scale <= 3; scale++)
+            {
+                const uint8_t quiet_zone = random() % 5;
+                const bool inverted      = random() % 2;
+                const int size           = qr_code.get_size();
+                const int modules        = size + 2 * quiet_zone;
+
+                // the first draw on screen, the rest off the top left, with and without a translation to undo
+                uint8_t origin_x      = random() % 10;
+                uint8_t origin_y      = random() % 10;
+                int16_t translation_x = pass % 2 ? static_cast<int16_t>(random() % 100) - 50 : 0;
+                int16_t translation_y = pass % 2 ? static_cast<int16_t>(random() % 60) - 30 : 0;
+
+                std::vector<int8_t> values =
+                    rasterize(qr_code, scale, quiet_zone, inverted, origin_x, origin_y, translation_x, translation_y);
+
+                // the symbol and its quiet zone are read from modules that filled every one of their pixels
+                bool is_whole = true;
+                for (int module_y = 0; module_y < modules; module_y++)
+                {
+                    for (int module_x = 0; module_x < modules; module_x++)
+                    {
+                        int8_t value  = values[module_y * modules + module_x];
+                        bool is_quiet = module_x < quiet_zone || module_y < quiet_zone || module_x >= quiet_zone + size ||
+                                        module_y >= quiet_zone + size;
+
+                        is_whole = is_whole && (value == 0 || (value == 1 && !is_quiet));
+                    }
+                }
+
+                CHECK(is_whole);
+
+                Decoded decoded = decode(size, [&](int x, int y) { return values[(y + quiet_zone) * modules + x + quiet_zone] == 1; });
+                CHECK(decoded.is_valid);
+                CHECK(decoded.payload == text);
+            }
+        }
+    }
+}    // namespace
+
+int main()
+{
+    std::mt19937 random(42);
+
+    test_round_trip(random);
+    test_rasterized(random);
+
+    return test_result();
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdio>
+
+// counts failed checks, a test's main returns test_result() so ctest sees them
+inline int test_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do                                                                                         \
+    {                                                                                          \
+        if (!(condition))                                                                      \
+        {                                                                                      \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++;                                                                   \
+        }                                                                                      \
+    } while (false)
+
+inline int test_result()
+{
+    if (test_failures > 0)
+        std::fprintf(stderr, "%d checks failed\n", test_failures);
+
+    return test_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Host side encoder for Animation assets
+//
+// build: c++ -std=c++20 -Isrc tools/animation_encode.cpp -o animation_encode
+// usage: animation_encode <name> <width> <height> <frame_period_ms> < frames.bin > animation.hpp
+//
+// the input is every frame back to back as raw page-major bitmaps, width * ceil(height / 8) bytes each.
+// the encoded animation is played back through AnimationPlayer and compared frame by frame before it's written out
+
+#include "animation.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+int main(int argc, char** argv)
+{
+    if (argc != 5)
+    {
+        std::fprintf(stderr, "usage: %s <name> <width> <height> <frame_period_ms> < frames.bin > animation.hpp\n", argv[0]);
+        return 1;
+    }
+
+    const char* name = argv[1];
+    int width        = std::atoi(argv[2]);
+    int height       = std::atoi(argv[3]);
+    int period_ms    = std::atoi(argv[4]);
+
+    // playback is verified on a panel sized framebuffer
+    if (width <= 0 || width > 128 || height <= 0 || height > 64 || period_ms < 0 || period_ms > 0xFFFF)
+    {
+        std::fprintf(stderr, "width must be in 1..128, height in 1..64 and frame_period_ms in 0..65535\n");
+        return 1;
+    }
+
+    size_t frame_size = static_cast<size_t>(width) * ((height + 7) / 8);
+    std::vector<uint8_t> frames;
+    std::vector<uint8_t> frame(frame_size);
+
+    while (std::fread(frame.data(), 1, frame_size, stdin) == frame_size)
+        frames.insert(frames.end(), frame.begin(), frame.end());
+
+    size_t frame_count = frames.size() / frame_size;
+    if (frame_count == 0 || frame_count > 0xFFFF)
+    {
+        std::fprintf(stderr, "expected 1..65535 frames of %zu bytes\n", frame_size);
+        return 1;
+    }
+
+    // worst case per frame is a keyframe of all literals, plus scratch space for the delta attempt
+    std::vector<uint8_t> encoded(Animation::HEADER_SIZE + frame_count * 3 * (frame_size + frame_size / 128 + 8));
+    size_t encoded_size = encode_animation_header(width, height, frame_count, period_ms, encoded.data(), encoded.size());
+    size_t keyframes    = 0;
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        const uint8_t* previous = (i == 0) ? nullptr : frames.data() + (i - 1) * frame_size;
+        const uint8_t* current  = frames.data() + i * frame_size;
+
+        size_t size = encode_animation_frame(previous, current, width, height, encoded.data() + encoded_size, encoded.size() - encoded_size);
+        if (size == 0)
+        {
+            std::fprintf(stderr, "encoding frame %zu failed\n", i);
+            return 1;
+        }
+
+        if (encoded[encoded_size] == static_cast<uint8_t>(AnimationFrameType::KEYFRAME))
+            keyframes++;
+
+        encoded_size += size;
+    }
+
+    Animation animation(encoded.data());
+    AnimationPlayer<128, 64> player(animation);
+    FrameBuffer<128, 64> framebuffer(false);
+
+    // two passes so looping back to the first keyframe is covered as well
+    for (size_t i = 0; i < frame_count * 2; i++)
+    {
+        player.next_frame(framebuffer);
+
+        // the padding rows below the last page aren't part of the animation
+        const uint8_t* expected = frames.data() + (i % frame_count) * frame_size;
+        for (uint8_t page = 0; page < (height + 7) / 8; page++)
+        {
+            const uint8_t mask = get_animation_page_mask(page, height);
+
+            for (uint8_t column = 0; column < width; column++)
+            {
+                if (((framebuffer.get_data()[page * 128 + column] ^ expected[page * width + column]) & mask) != 0)
+                {
+                    std::fprintf(stderr, "round trip mismatch on frame %zu page %u\n", i % frame_count, page);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::printf("#pragma once\n\n#include \"animation.hpp\"\n\n");
+    std::printf("// %zu frames, %zu keyframes, %zu -> %zu bytes\n", frame_count, keyframes, frame_count * frame_size, encoded_size);
+    std::printf("inline constexpr uint8_t %s_data[] = {", name);
+
+    for (size_t i = 0; i < encoded_size; i++)
+        std::printf("%s0x%02X,", (i % 12 == 0) ? "\n    " : " ", encoded[i]);
+
+    std::printf("\n};\n");
+    std::printf("inline constexpr ssd1306_pico::Animation %s(%s_data);\n", name, name);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+// Host side generator for fonts holding only the glyphs a build uses
+//
+// build: c++ -std=c++20 -Isrc tools/font_subset.cpp -o font_subset
+// usage: font_subset <small|medium|large|symbol> <name> [characters] > font.hpp
+//
+// the characters are UTF-8, read from stdin when they aren't given, so the strings a build shows can be
+// piped in as they are. line breaks are ignored. the glyphs are copied out of the built-in font into an
+// atlas of their own, and the tool fails if the font lacks one of them
+
+#include "default_fonts.hpp"
+#include "font.hpp"
+#include "symbol_font.hpp"
+#include "utf8.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+namespace
+{
+    bool get_pixel(const uint8_t* data, uint8_t width, uint8_t x, uint8_t y)
+    {
+        return data[x + (y / 8) * width] & (1 << (y % 8));
+    }
+
+    void set_pixel(uint8_t* data, uint8_t width, uint8_t x, uint8_t y)
+    {
+        data[x + (y / 8) * width] |= 1 << (y % 8);
+    }
+}    // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+    {
+        std::fprintf(stderr, "usage: %s <small|medium|large|symbol> <name> [characters] > font.hpp\n", argv[0]);
+        return 1;
+    }
+
+    const char* source_name = argv[1];
+    const char* name        = argv[2];
+
+    const Font* source = nullptr;
+    if (std::strcmp(source_name, "small") == 0)
+        source = &small_font;
+    else if (std::strcmp(source_name, "medium") == 0)
+        source = &medium_font;
+    else if (std::strcmp(source_name, "large") == 0)
+        source = &large_font;
+    else if (std::strcmp(source_name, "symbol") == 0)
+        source = &symbol_font;
+
+    if (source == nullptr)
+    {
+        std::fprintf(stderr, "unknown font %s\n", source_name);
+        return 1;
+    }
+
+    std::string text;
+    if (argc == 4)
+    {
+        text = argv[3];
+    }
+    else
+    {
+        char buffer[256];
+        size_t size;
+
+        while ((size = std::fread(buffer, 1, sizeof(buffer), stdin)) > 0)
+            text.append(buffer, size);
+    }
+
+    std::vector<char32_t> code_points;
+    for (const char* position = text.data(); position < text.data() + text.size();)
+    {
+        char32_t code_point = utf8_decode(position, text.data() + text.size());
+        if (code_point != '\n' && code_point != '\r')
+            code_points.push_back(code_point);
+    }
+
+    std::sort(code_points.begin(), code_points.end());
+    code_points.erase(std::unique(code_points.begin(), code_points.end()), code_points.end());
+
+    if (code_points.empty())
+    {
+        std::fprintf(stderr, "no characters given\n");
+        return 1;
+    }
+
+    for (char32_t code_point : code_points)
+    {
+        if (source->get_glyph_index(code_point) < 0)
+        {
+            std::fprintf(stderr, "%s font has no glyph for U+%04X\n", source_name, static_cast<unsigned>(code_point));
+            return 1;
+        }
+    }
+
+    // consecutive code points share a range, the glyphs are stored in code point order
+    std::vector<GlyphRange> ranges;
+    for (size_t i = 0; i < code_points.size(); i++)
+    {
+        if (!ranges.empty() && ranges.back().last + 1 == code_points[i])
+            ranges.back().last = code_points[i];
+        else
+            ranges.push_back({code_points[i], code_points[i], static_cast<uint16_t>(i)});
+    }
+
+    if (ranges.size() > 255)
+    {
+        std::fprintf(stderr, "%zu ranges, a font holds at most 255\n", ranges.size());
+        return 1;
+    }
+
+    const uint8_t glyph_width   = source->get_glyph_width();
+    const uint8_t glyph_height  = source->get_glyph_height();
+    const size_t glyphs_per_row = std::min<size_t>(code_points.size(), 255 / glyph_width);
+    const size_t rows           = (code_points.size() + glyphs_per_row - 1) / glyphs_per_row;
+
+    if (rows * glyph_height > 255)
+    {
+        std::fprintf(stderr, "%zu glyphs don't fit a 255 x 255 atlas\n", code_points.size());
+        return 1;
+    }
+
+    const uint8_t map_width  = glyphs_per_row * glyph_width;
+    const uint8_t map_height = rows * glyph_height;
+    std::vector<uint8_t> atlas(Bitmap::get_buffer_size(map_width, map_height));
+
+    const uint8_t* source_data = source->get_font_map().get_data();
+    const uint8_t source_width = source->get_font_map_width();
+
+    for (size_t i = 0; i < code_points.size(); i++)
+    {
+        int16_t glyph_index = source->get_glyph_index(code_points[i]);
+        uint8_t source_x    = source->get_glyph_map_x(glyph_index);
+        uint8_t source_y    = source->get_glyph_map_y(glyph_index);
+        uint8_t x           = (i % glyphs_per_row) * glyph_width;
+        uint8_t y           = (i / glyphs_per_row) * glyph_height;
+
+        for (uint8_t column = 0; column < glyph_width; column++)
+        {
+            for (uint8_t row = 0; row < glyph_height; row++)
+            {
+                if (get_pixel(source_data, source_width, source_x + column, source_y + row))
+                    set_pixel(atlas.data(), map_width, x + column, y + row);
+            }
+        }
+    }
+
+    std::vector<KerningPair> kerning_pairs;
+    for (char32_t left : code_points)
+    {
+        for (char32_t right : code_points)
+        {
+            int8_t adjust = source->get_kerning(left, right);
+            if (adjust != 0)
+                kerning_pairs.push_back({left, right, adjust});
+        }
+    }
+
+    // the copy is checked glyph by glyph against the source before it's written out
+    Font subset(glyph_width, glyph_height, map_width, map_height, Bitmap(map_width, map_height, atlas.data()), ranges.data(), ranges.size());
+
+    for (char32_t code_point : code_points)
+    {
+        int16_t source_index = source->get_glyph_index(code_point);
+        int16_t subset_index = subset.get_glyph_index(code_point);
+
+        for (uint8_t column = 0; column < glyph_width; column++)
+        {
+            for (uint8_t row = 0; row < glyph_height; row++)
+            {
+                bool expected = get_pixel(source_data, source_width, source->get_glyph_map_x(source_index) + column, source->get_glyph_map_y(source_index) + row);
+                bool actual   = get_pixel(atlas.data(), map_width, subset.get_glyph_map_x(subset_index) + column, subset.get_glyph_map_y(subset_index) + row);
+
+                if (expected != actual)
+                {
+                    std::fprintf(stderr, "subset mismatch for U+%04X\n", static_cast<unsigned>(code_point));
+                    return 1;
+                }
+            }
+        }
+    }
+
+    std::printf("#pragma once\n\n#include \"bitmap.hpp\"\n#include \"font.hpp\"\n\n");
+    std::printf("// %zu glyphs of %s_font, %zu -> %zu atlas bytes\n", code_points.size(), source_name,
+                static_cast<size_t>(Bitmap::get_buffer_size(source_width, source->get_font_map_height())), atlas.size());
+    std::printf("inline constexpr uint8_t %s_buffer[] = {", name);
+
+    for (size_t i = 0; i < atlas.size(); i++)
+        std::printf("%s0x%02X,", (i % 12 == 0) ? "\n    " : " ", atlas[i]);
+
+    std::printf("\n};\n");
+    std::printf("inline constexpr ssd1306_pico::GlyphRange %s_ranges[] = {\n", name);
+
+    for (const GlyphRange& range : ranges)
+        std::printf("    {0x%04X, 0x%04X, %u},\n", static_cast<unsigned>(range.first), static_cast<unsigned>(range.last), range.glyph_index);
+
+    std::printf("};\n");
+    std::printf("inline constexpr ssd1306_pico::GlyphExtents<%u, %u, %u, %u> %s_extents(%s_buffer);\n", glyph_width, glyph_height, map_width, map_height, name,
+                name);
+
+    if (kerning_pairs.empty())
+    {
+        std::printf("inline constexpr ssd1306_pico::Font %s(%u, %u, %u, %u, ssd1306_pico::Bitmap(%u, %u, %s_buffer), %s_ranges, %zu, nullptr, 0, %s_extents.extents);\n",
+                    name, glyph_width, glyph_height, map_width, map_height, map_width, map_height, name, name, ranges.size(), name);
+        return 0;
+    }
+
+    std::printf("inline constexpr ssd1306_pico::KerningPair %s_kerning_pairs[] = {\n", name);
+
+    for (const KerningPair& pair : kerning_pairs)
+        std::printf("    {0x%04X, 0x%04X, %d},\n", static_cast<unsigned>(pair.left), static_cast<unsigned>(pair.right), pair.adjust);
+
+    std::printf("};\n");
+    std::printf("inline constexpr ssd1306_pico::Font %s(%u, %u, %u, %u, ssd1306_pico::Bitmap(%u, %u, %s_buffer), %s_ranges, %zu, %s_kerning_pairs, %zu, "
+                "%s_extents.extents);\n",
+                name, glyph_width, glyph_height, map_width, map_height, map_width, map_height, name, name, ranges.size(), name, kerning_pairs.size(), name);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Host side encoder for CompressedBitmap assets
+//
+// build: c++ -std=c++20 -Isrc tools/rle_encode.cpp -o rle_encode
+// usage: rle_encode [--row-major] <name> <width> <height> < image.bin > image.hpp
+//
+// the input is a raw page-major bitmap, width * ceil(height / 8) bytes, the same layout Bitmap takes.
+// with --row-major it's rows of ceil(width / 8) bytes, most significant bit first, like the PBM raster.
+// every asset is decoded again before it's written out, the tool fails if the round trip doesn't match
+
+#include "compressed_bitmap.hpp"
+#include "transpose.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace ssd1306_pico;
+
+int main(int argc, char** argv)
+{
+    bool is_row_major = argc == 5 && std::strcmp(argv[1], "--row-major") == 0;
+    if (is_row_major)
+    {
+        argc--;
+        argv++;
+    }
+
+    if (argc != 4)
+    {
+        std::fprintf(stderr, "usage: %s [--row-major] <name> <width> <height> < image.bin > image.hpp\n", argv[0]);
+        return 1;
+    }
+
+    const char* name = argv[1];
+    int width        = std::atoi(argv[2]);
+    int height       = std::atoi(argv[3]);
+
+    if (width <= 0 || width > 255 || height <= 0 || height > 255)
+    {
+        std::fprintf(stderr, "width and height must be in 1..255\n");
+        return 1;
+    }
+
+    size_t raw_size   = static_cast<size_t>(width) * ((height + 7) / 8);
+    size_t input_size = is_row_major ? static_cast<size_t>((width + 7) / 8) * height : raw_size;
+    std::vector<uint8_t> input(input_size);
+    std::vector<uint8_t> raw(raw_size);
+
+    if (std::fread(input.data(), 1, input_size, stdin) != input_size)
+    {
+        std::fprintf(stderr, "expected %zu bytes of %s data\n", input_size, is_row_major ? "row-major" : "page-major");
+        return 1;
+    }
+
+    if (is_row_major)
+        row_major_to_page_major(input.data(), width, height, raw.data());
+    else
+        raw = input;
+
+    // worst case is one control byte per 128 literals
+    std::vector<uint8_t> encoded(raw_size + raw_size / 128 + 1);
+    size_t encoded_size = rle_encode(raw.data(), raw.size(), encoded.data(), encoded.size());
+
+    if (encoded_size == 0)
+    {
+        std::fprintf(stderr, "encoding failed\n");
+        return 1;
+    }
+
+    RleReader reader(encoded.data());
+    for (size_t i = 0; i < raw_size; i++)
+    {
+        if (reader.next() != raw[i])
+        {
+            std::fprintf(stderr, "round trip mismatch at byte %zu\n", i);
+            return 1;
+        }
+    }
+
+    if (reader.get_position() != encoded.data() + encoded_size)
+    {
+        std::fprintf(stderr, "round trip did not consume the whole stream\n");
+        return 1;
+    }
+
+    std::printf("#pragma once\n\n#include \"compressed_bitmap.hpp\"\n\n");
+    std::printf("// %zu -> %zu bytes\n", raw_size, encoded_size);
+    std::printf("inline constexpr uint8_t %s_data[] = {", name);
+
+    for (size_t i = 0; i < encoded_size; i++)
+        std::printf("%s0x%02X,", (i % 12 == 0) ? "\n    " : " ", encoded[i]);
+
+    std::printf("\n};\n");
+    std::printf("inline constexpr ssd1306_pico::CompressedBitmap %s(%d, %d, %s_data);\n", name, width, height, name);
+
+    return 0;
+}